@@ -0,0 +1,194 @@
+// Kernels of bitspan and bitvec.
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include "bitvec.hxx"
+#include "harness.hxx"
+
+using word = default_bitspan_word;
+
+/// Fills with independent bits set with probability ~density.  Dense fills
+/// draw whole random words, sparse ones scatter density * len indices.
+static bitvec<word> make_filled(size_t bits, double density, uint64_t seed) {
+    bitvec<word> bv(bits);
+    splitmix64 rng(seed);
+    if (density >= 0.5) {
+        for (auto& w : bv.words()) w = static_cast<word>(rng());
+    } else {
+        auto s = bv.span();
+        auto n = static_cast<size_t>(static_cast<double>(bits) * density);
+        for (size_t k = 0; k < n; k++) s[rng() % bits] = true;
+    }
+    return bv;
+}
+
+static size_t bytes_of(bitvec<word> const& bv) { return bv.words().count() * sizeof(word); }
+
+/// Streambuf that drops everything written to it.
+struct null_buf final : std::streambuf {
+    std::streamsize xsputn(char const*, std::streamsize n) override { return n; }
+    int_type overflow(int_type c) override { return c; }
+};
+
+template<typename Op>
+static bench_case binary_case(std::string name, Op op) {
+    return { .name = std::move(name), .setup = [op](bench_config cfg) {
+        auto a = std::make_shared<bitvec<word>>(make_filled(cfg.bits, cfg.density, 1));
+        auto b = std::make_shared<bitvec<word>>(make_filled(cfg.bits, cfg.density, 2));
+        return bench_fixture { .run = [a, b, op](size_t n) {
+            for (size_t i = 0; i < n; i++) { op(*a, *b); clobber_memory(); }
+        }, .bytes_per_op = 2 * bytes_of(*a) };
+    } };
+}
+
+template<typename Op>
+static bench_case unary_case(std::string name, Op op) {
+    return { .name = std::move(name), .setup = [op](bench_config cfg) {
+        auto a = std::make_shared<bitvec<word>>(make_filled(cfg.bits, cfg.density, 1));
+        return bench_fixture { .run = [a, op](size_t n) {
+            for (size_t i = 0; i < n; i++) { op(*a); clobber_memory(); }
+        }, .bytes_per_op = bytes_of(*a) };
+    } };
+}
+
+// --- bulk operations ---
+static bench_registrar reg_and(binary_case("bitspan/and_assign",
+    [](bitvec<word>& a, bitvec<word> const& b) { a &= b; }));
+static bench_registrar reg_or(binary_case("bitspan/or_assign",
+    [](bitvec<word>& a, bitvec<word> const& b) { a |= b; }));
+static bench_registrar reg_xor(binary_case("bitspan/xor_assign",
+    [](bitvec<word>& a, bitvec<word> const& b) { a ^= b; }));
+static bench_registrar reg_and_not(binary_case("bitspan/and_not",
+    [](bitvec<word>& a, bitvec<word> const& b) { a.and_not(b); }));
+static bench_registrar reg_set_from(binary_case("bitspan/set_from",
+    [](bitvec<word>& a, bitvec<word> const& b) { a.set_from(b); }));
+static bench_registrar reg_invert(unary_case("bitspan/invert",
+    [](bitvec<word>& a) { a.invert(); }));
+static bench_registrar reg_reset(unary_case("bitspan/reset",
+    [](bitvec<word>& a) { a.reset(); }));
+// --- end bulk operations ---
+
+// --- scans ---
+static bench_registrar reg_equal(bench_case { .name = "bitspan/equal", .setup = [](bench_config cfg) {
+    auto a = std::make_shared<bitvec<word>>(make_filled(cfg.bits, cfg.density, 1));
+    auto b = std::make_shared<bitvec<word>>(*a); // equal operands scan everything
+    return bench_fixture { .run = [a, b](size_t n) {
+        for (size_t i = 0; i < n; i++) do_not_optimize(*a == *b);
+    }, .bytes_per_op = 2 * bytes_of(*a) };
+} });
+static bench_registrar reg_count(unary_case("bitspan/count",
+    [](bitvec<word>& a) { do_not_optimize(a.count()); }));
+static bench_registrar reg_count_and(binary_case("bitspan/count_and",
+    [](bitvec<word>& a, bitvec<word> const& b) { do_not_optimize(a.count_and(b)); }));
+static bench_registrar reg_is_subset(bench_case { .name = "bitspan/is_subset_of",
+                                                  .setup = [](bench_config cfg) {
+    auto b = std::make_shared<bitvec<word>>(make_filled(cfg.bits, cfg.density, 2));
+    auto a = std::make_shared<bitvec<word>>(*b); // a subset never exits early
+    return bench_fixture { .run = [a, b](size_t n) {
+        for (size_t i = 0; i < n; i++) do_not_optimize(a->is_subset_of(*b));
+    }, .bytes_per_op = 2 * bytes_of(*a) };
+} });
+static bench_registrar reg_iter(bench_case { .name = "bitspan/iter_ones", .setup = [](bench_config cfg) {
+    auto a = std::make_shared<bitvec<word>>(make_filled(cfg.bits, cfg.density, 1));
+    return bench_fixture { .run = [a](size_t n) {
+        for (size_t i = 0; i < n; i++)
+            for (auto it = a->iter<true>(); auto j = it.next();) do_not_optimize(*j);
+    }, .bytes_per_op = bytes_of(*a), .items_per_op = std::max<size_t>(1, a->count()) };
+}, .density_sensitive = true });
+static bench_registrar reg_ostream(bench_case { .name = "bitspan/ostream", .setup = [](bench_config cfg) {
+    auto a = std::make_shared<bitvec<word>>(make_filled(cfg.bits, cfg.density, 1));
+    return bench_fixture { .run = [a](size_t n) {
+        null_buf buf;
+        std::ostream os(&buf);
+        for (size_t i = 0; i < n; i++) os << *a;
+    }, .bytes_per_op = cfg.bits, .items_per_op = cfg.bits };
+}, .max_bits = size_t(1) << 27 });
+// --- end scans ---
+
+// --- indexing through bit_ref ---
+static constexpr size_t probe_count = 4096;
+
+static bench_registrar reg_ref_seq(bench_case { .name = "bit_ref/read_sequential",
+                                                .setup = [](bench_config cfg) {
+    auto a = std::make_shared<bitvec<word>>(make_filled(cfg.bits, cfg.density, 1));
+    return bench_fixture { .run = [a](size_t n) {
+        auto s = a->span();
+        for (size_t i = 0; i < n; i++) {
+            size_t sum = 0;
+            for (size_t j = 0; j < s.len(); j++) sum += s[j];
+            do_not_optimize(sum);
+        }
+    }, .items_per_op = cfg.bits };
+}, .max_bits = size_t(1) << 27 });
+
+static std::shared_ptr<std::vector<size_t>> random_indices(size_t bits) {
+    auto idx = std::make_shared<std::vector<size_t>>(probe_count);
+    splitmix64 rng(3);
+    for (auto& i : *idx) i = rng() % bits;
+    return idx;
+}
+static bench_registrar reg_ref_read(bench_case { .name = "bit_ref/read_random",
+                                                 .setup = [](bench_config cfg) {
+    auto a = std::make_shared<bitvec<word>>(make_filled(cfg.bits, cfg.density, 1));
+    auto idx = random_indices(cfg.bits);
+    return bench_fixture { .run = [a, idx](size_t n) {
+        auto s = a->span();
+        for (size_t i = 0; i < n; i++) {
+            size_t sum = 0;
+            for (size_t j : *idx) sum += s[j];
+            do_not_optimize(sum);
+        }
+    }, .items_per_op = probe_count };
+} });
+static bench_registrar reg_ref_write(bench_case { .name = "bit_ref/write_random",
+                                                  .setup = [](bench_config cfg) {
+    auto a = std::make_shared<bitvec<word>>(make_filled(cfg.bits, cfg.density, 1));
+    auto idx = random_indices(cfg.bits);
+    return bench_fixture { .run = [a, idx](size_t n) {
+        auto s = a->span();
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j : *idx) s[j] = (j & 1) != 0;
+            clobber_memory();
+        }
+    }, .items_per_op = probe_count };
+} });
+// --- end indexing through bit_ref ---
+
+// --- memory management ---
+static bench_registrar reg_resize(bench_case { .name = "bitvec/resize_from_empty",
+                                               .setup = [](bench_config cfg) {
+    return bench_fixture { .run = [bits = cfg.bits](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            bitvec<word> v;
+            v.resize(bits);
+            do_not_optimize(v.words().begin());
+        }
+    }, .bytes_per_op = bitvec<word>::bytes_for_bitcount(cfg.bits) };
+} });
+static bench_registrar reg_grow(bench_case { .name = "bitvec/resize_grow_16_steps",
+                                             .setup = [](bench_config cfg) {
+    return bench_fixture { .run = [bits = cfg.bits](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            bitvec<word> v;
+            for (size_t k = 1; k <= 16; k++) v.resize(bits / 16 * k);
+            do_not_optimize(v.words().begin());
+        }
+    }, .bytes_per_op = bitvec<word>::bytes_for_bitcount(cfg.bits) };
+} });
+static bench_registrar reg_reserve(bench_case { .name = "bitvec/reserve_for_exact",
+                                                .setup = [](bench_config cfg) {
+    return bench_fixture { .run = [bits = cfg.bits](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            bitvec<word> v;
+            do_not_optimize(v.reserve_for_exact(bits));
+        }
+    } };
+} });
+static bench_registrar reg_copy(bench_case { .name = "bitvec/copy_assign", .setup = [](bench_config cfg) {
+    auto a = std::make_shared<bitvec<word>>(make_filled(cfg.bits, cfg.density, 1));
+    auto b = std::make_shared<bitvec<word>>();
+    return bench_fixture { .run = [a, b](size_t n) {
+        for (size_t i = 0; i < n; i++) { *b = *a; clobber_memory(); }
+    }, .bytes_per_op = 2 * bytes_of(*a) };
+} });
+// --- end memory management ---
@@ -0,0 +1,219 @@
+// The same workloads run against bitvec, std::vector<bool> and std::bitset<N>.
+// std::bitset only exists for the sizes listed in bitset_sizes below.
+#include <algorithm>
+#include <bitset>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "bitvec.hxx"
+#include "harness.hxx"
+
+using word = default_bitspan_word;
+
+static constexpr size_t probe_count  = 4096;
+static constexpr size_t compare_max  = size_t(1) << 27;
+template<size_t... Ns> struct size_list {};
+using bitset_sizes = size_list<64, 4096, 262144, 16777216>;
+
+// --- container adapters ---
+// Each container is driven through its own idiomatic interface.
+template<typename C> struct adapter;
+
+template<> struct adapter<bitvec<word>> {
+    static constexpr char const* name = "bitvec";
+    static auto make(size_t bits) { return std::make_shared<bitvec<word>>(bits); }
+    static void set (bitvec<word>& c, size_t i)       { c[i] = true; }
+    static bool test(bitvec<word> const& c, size_t i) { return c[i]; }
+    static void and_assign(bitvec<word>& a, bitvec<word> const& b) { a &= b; }
+    static void or_assign (bitvec<word>& a, bitvec<word> const& b) { a |= b; }
+    static void xor_assign(bitvec<word>& a, bitvec<word> const& b) { a ^= b; }
+    static size_t count(bitvec<word> const& c) { return c.count(); }
+    template<typename F> static void for_each_one(bitvec<word> const& c, F f)
+        { for (auto it = c.iter<true>(); auto i = it.next();) f(*i); }
+};
+
+template<> struct adapter<std::vector<bool>> {
+    using C = std::vector<bool>;
+    static constexpr char const* name = "vector<bool>";
+    static auto make(size_t bits) { return std::make_shared<C>(bits); }
+    static void set (C& c, size_t i)       { c[i] = true; }
+    static bool test(C const& c, size_t i) { return c[i]; }
+    static void and_assign(C& a, C const& b)
+        { std::transform(a.begin(), a.end(), b.begin(), a.begin(), std::bit_and<bool>()); }
+    static void or_assign (C& a, C const& b)
+        { std::transform(a.begin(), a.end(), b.begin(), a.begin(), std::bit_or<bool>()); }
+    static void xor_assign(C& a, C const& b)
+        { std::transform(a.begin(), a.end(), b.begin(), a.begin(), std::bit_xor<bool>()); }
+    static size_t count(C const& c) { return std::count(c.begin(), c.end(), true); }
+    template<typename F> static void for_each_one(C const& c, F f)
+        { for (size_t i = 0; i < c.size(); i++) if (c[i]) f(i); }
+};
+
+template<size_t N> struct adapter<std::bitset<N>> {
+    using C = std::bitset<N>;
+    static constexpr char const* name = "bitset<N>";
+    static auto make(size_t) { return std::make_shared<C>(); }
+    static void set (C& c, size_t i)       { c[i] = true; }
+    static bool test(C const& c, size_t i) { return c[i]; }
+    static void and_assign(C& a, C const& b) { a &= b; }
+    static void or_assign (C& a, C const& b) { a |= b; }
+    static void xor_assign(C& a, C const& b) { a ^= b; }
+    static size_t count(C const& c) { return c.count(); }
+    template<typename F> static void for_each_one(C const& c, F f) {
+#if defined(__GLIBCXX__)
+        for (size_t i = c._Find_first(); i < N; i = c._Find_next(i)) f(i);
+#else
+        for (size_t i = 0; i < N; i++) if (c[i]) f(i);
+#endif
+    }
+};
+
+/// A container of cfg.bits holding the same pseudo-random pattern for every C.
+template<typename C>
+static std::shared_ptr<C> make_filled(bench_config cfg, uint64_t seed) {
+    auto c = adapter<C>::make(cfg.bits);
+    splitmix64 rng(seed);
+    if (cfg.density >= 0.5) {
+        for (size_t i = 0; i < cfg.bits; i += 64)
+            for (uint64_t w = rng(), j = i; j < std::min(cfg.bits, i + 64); j++, w >>= 1)
+                if (w & 1) adapter<C>::set(*c, j);
+    } else {
+        auto n = static_cast<size_t>(static_cast<double>(cfg.bits) * cfg.density);
+        for (size_t k = 0; k < n; k++) adapter<C>::set(*c, rng() % cfg.bits);
+    }
+    return c;
+}
+
+static std::shared_ptr<std::vector<size_t>> random_indices(size_t bits) {
+    auto idx = std::make_shared<std::vector<size_t>>(probe_count);
+    splitmix64 rng(3);
+    for (auto& i : *idx) i = rng() % bits;
+    return idx;
+}
+// --- end container adapters ---
+
+// --- workloads ---
+struct random_set final {
+    static constexpr char const* name = "random_set";
+    static constexpr bool density_sensitive = false;
+    template<typename C> static bench_fixture make(bench_config cfg) {
+        auto a = make_filled<C>(cfg, 1);
+        auto idx = random_indices(cfg.bits);
+        return { .run = [a, idx](size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                for (size_t j : *idx) adapter<C>::set(*a, j);
+                clobber_memory();
+            }
+        }, .items_per_op = probe_count };
+    }
+};
+
+struct random_test final {
+    static constexpr char const* name = "random_test";
+    static constexpr bool density_sensitive = false;
+    template<typename C> static bench_fixture make(bench_config cfg) {
+        auto a = make_filled<C>(cfg, 1);
+        auto idx = random_indices(cfg.bits);
+        return { .run = [a, idx](size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                size_t sum = 0;
+                for (size_t j : *idx) sum += adapter<C>::test(*a, j);
+                do_not_optimize(sum);
+            }
+        }, .items_per_op = probe_count };
+    }
+};
+
+template<int which> // 0: and, 1: or, 2: xor
+struct bulk_op final {
+    static constexpr char const* name = which == 0 ? "and_assign"
+                                      : which == 1 ? "or_assign" : "xor_assign";
+    static constexpr bool density_sensitive = false;
+    template<typename C> static bench_fixture make(bench_config cfg) {
+        auto a = make_filled<C>(cfg, 1), b = make_filled<C>(cfg, 2);
+        return { .run = [a, b](size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                if constexpr (which == 0) adapter<C>::and_assign(*a, *b);
+                if constexpr (which == 1) adapter<C>::or_assign (*a, *b);
+                if constexpr (which == 2) adapter<C>::xor_assign(*a, *b);
+                clobber_memory();
+            }
+        }, .bytes_per_op = 2 * (cfg.bits / 8) };
+    }
+};
+
+struct count_ones final {
+    static constexpr char const* name = "count";
+    static constexpr bool density_sensitive = false;
+    template<typename C> static bench_fixture make(bench_config cfg) {
+        auto a = make_filled<C>(cfg, 1);
+        return { .run = [a](size_t n) {
+            for (size_t i = 0; i < n; i++) do_not_optimize(adapter<C>::count(*a));
+        }, .bytes_per_op = cfg.bits / 8 };
+    }
+};
+
+struct iterate_ones final {
+    static constexpr char const* name = "iterate_ones";
+    static constexpr bool density_sensitive = true;
+    template<typename C> static bench_fixture make(bench_config cfg) {
+        auto a = make_filled<C>(cfg, 1);
+        return { .run = [a](size_t n) {
+            for (size_t i = 0; i < n; i++)
+                adapter<C>::for_each_one(*a, [](size_t j) { do_not_optimize(j); });
+        }, .bytes_per_op = cfg.bits / 8,
+           .items_per_op = std::max<size_t>(1, adapter<C>::count(*a)) };
+    }
+};
+
+struct copy_assign final {
+    static constexpr char const* name = "copy_assign";
+    static constexpr bool density_sensitive = false;
+    template<typename C> static bench_fixture make(bench_config cfg) {
+        auto a = make_filled<C>(cfg, 1), b = adapter<C>::make(cfg.bits);
+        return { .run = [a, b](size_t n) {
+            for (size_t i = 0; i < n; i++) { *b = *a; clobber_memory(); }
+        }, .bytes_per_op = 2 * (cfg.bits / 8) };
+    }
+};
+// --- end workloads ---
+
+// --- registration ---
+template<typename Workload, size_t N, size_t... Ns>
+static bench_fixture bitset_fixture(bench_config cfg) {
+    if (cfg.bits == N) return Workload::template make<std::bitset<N>>(cfg);
+    if constexpr (sizeof...(Ns) != 0) return bitset_fixture<Workload, Ns...>(cfg);
+    else return {};
+}
+template<typename Workload, size_t... Ns>
+static bench_fixture bitset_fixture(bench_config cfg, size_list<Ns...>)
+    { return bitset_fixture<Workload, Ns...>(cfg); }
+
+template<typename Workload>
+struct compare_registrar final {
+    compare_registrar() {
+        std::string group = std::string("compare/") + Workload::name;
+        auto add = [&](char const* impl, bool subject, auto setup) {
+            bench_registry().push_back({ .name = group + "/" + impl, .setup = setup,
+                                         .density_sensitive = Workload::density_sensitive,
+                                         .max_bits = compare_max,
+                                         .group = group, .subject = subject });
+        };
+        add(adapter<bitvec<word>>::name, true,
+            [](bench_config cfg) { return Workload::template make<bitvec<word>>(cfg); });
+        add(adapter<std::vector<bool>>::name, false,
+            [](bench_config cfg) { return Workload::template make<std::vector<bool>>(cfg); });
+        add(adapter<std::bitset<64>>::name, false,
+            [](bench_config cfg) { return bitset_fixture<Workload>(cfg, bitset_sizes()); });
+    }
+};
+
+static compare_registrar<random_set>   reg_random_set;
+static compare_registrar<random_test>  reg_random_test;
+static compare_registrar<bulk_op<0>>   reg_and;
+static compare_registrar<bulk_op<1>>   reg_or;
+static compare_registrar<bulk_op<2>>   reg_xor;
+static compare_registrar<count_ones>   reg_count;
+static compare_registrar<iterate_ones> reg_iterate_ones;
+static compare_registrar<copy_assign>  reg_copy_assign;
+// --- end registration ---
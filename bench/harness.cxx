@@ -0,0 +1,213 @@
+// Benchmark driver.
+//
+// usage: finitesets-bench [--filter=SUBSTR] [--min-bits=N] [--max-bits=N]
+//                         [--reps=N] [--min-time-ms=N] [--perf]
+//
+// Every case is run for each size 64 * 8^k bits in [min-bits, max-bits] and,
+// if it depends on the data, for each density.  A run is calibrated so one
+// sample takes at least min-time, warmed up once, then sampled `reps` times;
+// the median sample is reported.  Grouped cases are compared at the end and
+// every configuration where this library's container loses is flagged.
+//
+// With --perf, hardware counters are read over the sampled runs and reported
+// as IPC, branch misses per op and L1D/LLC misses per word touched (per item
+// when a case touches no contiguous memory).  If perf events can't be opened
+// the run continues without them.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include "harness.hxx"
+#include "perf_counters.hxx"
+
+std::vector<bench_case>& bench_registry() {
+    static std::vector<bench_case> cases;
+    return cases;
+}
+
+struct options final {
+    std::string filter;
+    size_t      min_bits    = 64;
+    size_t      max_bits    = size_t(1) << 30;
+    size_t      reps        = 7;
+    double      min_time_ms = 20;
+    bool        perf        = false;
+};
+
+static constexpr double densities[] = {0.5, 0.01, 0.0001};
+
+static bool parse_flag(std::string_view arg, std::string_view name, std::string_view& val) {
+    if (!arg.starts_with(name) || arg.size() <= name.size() || arg[name.size()] != '=')
+        return false;
+    val = arg.substr(name.size() + 1);
+    return true;
+}
+
+static options parse_options(int argc, char** argv) {
+    options opts;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i], val;
+        auto num = [&] { return std::strtoull(std::string(val).c_str(), nullptr, 10); };
+        if      (parse_flag(arg, "--filter",      val)) opts.filter      = val;
+        else if (parse_flag(arg, "--min-bits",    val)) opts.min_bits    = num();
+        else if (parse_flag(arg, "--max-bits",    val)) opts.max_bits    = num();
+        else if (parse_flag(arg, "--reps",        val)) opts.reps        = std::max(1ULL, num());
+        else if (parse_flag(arg, "--min-time-ms", val)) opts.min_time_ms = num();
+        else if (arg == "--perf")                       opts.perf        = true;
+        else {
+            std::cerr << "unknown argument: " << arg << '\n';
+            std::exit(2); // NOLINT
+        }
+    }
+    return opts;
+}
+
+static double time_ns(bench_fixture const& f, size_t iters) {
+    auto t0 = std::chrono::steady_clock::now();
+    f.run(iters);
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+struct result final {
+    double ns_per_op;
+    size_t iters;
+    perf_counters::reading per_op {};
+};
+
+static result measure(bench_fixture const& f, options const& opts, perf_counters* perf) {
+    const double min_ns = opts.min_time_ms * 1e6;
+    size_t iters = 1;
+    double ns = time_ns(f, iters); // doubles as the first warm-up
+    while (ns < min_ns && iters < (size_t(1) << 40)) {
+        iters = (ns <= 0) ? iters * 16
+              : std::max(iters * 2, static_cast<size_t>(iters * min_ns / ns * 1.2));
+        ns = time_ns(f, iters);
+    }
+    (void)time_ns(f, iters); // warm-up at the calibrated count
+    std::vector<double> samples(opts.reps);
+    if (perf != nullptr) perf->start();
+    for (auto& s : samples) s = time_ns(f, iters) / iters;
+    perf_counters::reading per_op {};
+    if (perf != nullptr) {
+        per_op = perf->stop();
+        for (auto& v : per_op) if (v) *v /= static_cast<double>(iters * opts.reps);
+    }
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return { samples[samples.size() / 2], iters, per_op };
+}
+
+static void print_header(bool perf) {
+    std::cout << std::left  << std::setw(34) << "benchmark"
+              << std::right << std::setw(13) << "bits"
+              << std::setw(9)  << "density"
+              << std::setw(15) << "ns/op"
+              << std::setw(12) << "ns/item"
+              << std::setw(10) << "GB/s";
+    if (perf) std::cout << std::setw(8)  << "IPC"
+                        << std::setw(12) << "br-miss/op"
+                        << std::setw(13) << "L1D-miss/w"
+                        << std::setw(13) << "LLC-miss/w";
+    std::cout << '\n';
+}
+
+static void print_value(std::optional<double> v, int width) {
+    if (v) std::cout << std::setw(width) << *v; else std::cout << std::setw(width) << '-';
+}
+
+static void print_counters(bench_fixture const& f, perf_counters::reading const& r) {
+    using pc = perf_counters;
+    auto per = [](std::optional<double> v, double d) -> std::optional<double>
+        { return (v && d > 0) ? std::optional(*v / d) : std::nullopt; };
+    double words = (f.bytes_per_op != 0)
+        ? static_cast<double>(f.bytes_per_op) / static_cast<double>(f.word_bytes)
+        : static_cast<double>(f.items_per_op);
+    std::cout << std::setprecision(2);
+    print_value((r[pc::cycles] && r[pc::instructions])
+                    ? per(r[pc::instructions], *r[pc::cycles]) : std::nullopt, 8);
+    std::cout << std::setprecision(3);
+    print_value(r[pc::branch_misses], 12);
+    print_value(per(r[pc::l1d_misses], words), 13);
+    print_value(per(r[pc::llc_misses], words), 13);
+}
+
+static void print_row(bench_case const& c, bench_config cfg, bench_fixture const& f,
+                      result const& r, bool perf) {
+    std::cout << std::left  << std::setw(34) << c.name
+              << std::right << std::setw(13) << cfg.bits << std::setw(9);
+    if (c.density_sensitive) std::cout << cfg.density; else std::cout << '-';
+    std::cout << std::setw(15) << std::fixed << std::setprecision(1) << r.ns_per_op
+              << std::setw(12) << std::setprecision(3);
+    if (f.items_per_op != 0) std::cout << r.ns_per_op / f.items_per_op; else std::cout << '-';
+    std::cout << std::setw(10) << std::setprecision(2);
+    if (f.bytes_per_op != 0) std::cout << f.bytes_per_op / r.ns_per_op; else std::cout << '-';
+    if (perf) print_counters(f, r.per_op);
+    std::cout << std::defaultfloat << std::setprecision(6) << std::endl;
+}
+
+struct grouped_result final {
+    std::string name;
+    bool        subject;
+    double      ns_per_op;
+};
+using group_key = std::tuple<std::string, size_t, double>;
+
+static void print_comparison(std::map<group_key, std::vector<grouped_result>> const& groups) {
+    if (groups.empty()) return;
+    size_t losses = 0;
+    std::cout << "\ncomparison (subject vs fastest alternative):\n";
+    for (auto const& [key, results] : groups) {
+        auto subj = std::find_if(results.begin(), results.end(),
+                                 [](auto const& r) { return r.subject; });
+        if (subj == results.end()) continue;
+        for (auto const& r : results) {
+            if (r.subject || r.ns_per_op >= subj->ns_per_op) continue;
+            losses++;
+            std::cout << "  SLOWER  " << std::get<0>(key) << " bits=" << std::get<1>(key)
+                      << " density=" << std::get<2>(key) << ": " << subj->name << ' '
+                      << subj->ns_per_op << " ns vs " << r.name << ' ' << r.ns_per_op
+                      << " ns (" << subj->ns_per_op / r.ns_per_op << "x)\n";
+        }
+    }
+    if (losses == 0) std::cout << "  subject is fastest in every configuration\n";
+}
+
+int main(int argc, char** argv) {
+    auto opts = parse_options(argc, argv);
+    std::optional<perf_counters> perf;
+    if (opts.perf) {
+        perf.emplace();
+        if (!perf->available()) {
+            std::cerr << "hardware counters unavailable (" << perf->error()
+                      << "), continuing without them\n";
+            perf.reset();
+        }
+    }
+    print_header(perf.has_value());
+    std::map<group_key, std::vector<grouped_result>> groups;
+    for (auto const& c : bench_registry()) {
+        if (!opts.filter.empty() && c.name.find(opts.filter) == std::string::npos) continue;
+        for (size_t bits = 64; bits <= std::min(opts.max_bits, c.max_bits); bits *= 8) {
+            if (bits < opts.min_bits) continue;
+            for (double d : densities) {
+                bench_config cfg { .bits = bits, .density = d };
+                auto fixture = c.setup(cfg);
+                if (!fixture.run) continue;
+                auto r = measure(fixture, opts, perf ? &*perf : nullptr);
+                print_row(c, cfg, fixture, r, perf.has_value());
+                if (!c.group.empty())
+                    groups[{c.group, bits, c.density_sensitive ? d : 0}]
+                        .push_back({ c.name, c.subject, r.ns_per_op });
+                if (!c.density_sensitive) break;
+            }
+            if (bits > SIZE_MAX / 8) break;
+        }
+    }
+    print_comparison(groups);
+}
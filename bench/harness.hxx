@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// Keeps the compiler from discarding a value whose computation is timed.
+template<typename T>
+inline void do_not_optimize(T const& value) { asm volatile("" : : "r,m"(value) : "memory"); }
+/// Keeps the compiler from assuming memory is unchanged across the barrier.
+inline void clobber_memory() { asm volatile("" : : : "memory"); }
+
+/// One point of the parameter grid a benchmark is run at.
+struct bench_config final {
+    size_t bits;
+    double density;
+};
+
+/// A prepared benchmark: `run(n)` performs the measured operation n times.
+/// A setup may return a fixture without `run` to skip a configuration.
+struct bench_fixture final {
+    std::function<void(size_t)> run;
+    size_t bytes_per_op = 0; ///< memory touched by one operation, 0 if meaningless
+    size_t items_per_op = 0; ///< e.g. indices probed by one operation, 0 if meaningless
+    size_t word_bytes   = sizeof(uintptr_t); ///< word width for the per-word miss rates
+};
+
+struct bench_case final {
+    std::string name;
+    std::function<bench_fixture(bench_config)> setup;
+    bool   density_sensitive = false;
+    size_t max_bits          = SIZE_MAX;
+    /// Cases sharing a group run the same workload on different containers;
+    /// the report flags configurations where the subject is not the fastest.
+    std::string group {};
+    bool        subject = false;
+};
+
+/// All registered cases, in registration order within each translation unit.
+std::vector<bench_case>& bench_registry();
+
+struct bench_registrar final {
+    explicit bench_registrar(bench_case c) { bench_registry().push_back(std::move(c)); }
+};
+
+/// Cheap deterministic generator for filling benchmark inputs.
+struct splitmix64 final {
+    uint64_t state;
+    explicit constexpr splitmix64(uint64_t seed) noexcept : state(seed) {}
+    constexpr uint64_t operator()() noexcept {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
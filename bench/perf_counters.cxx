@@ -0,0 +1,78 @@
+#include "perf_counters.hxx"
+#include <cerrno>
+#include <cstring>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+static int open_event(uint32_t type, uint64_t config) {
+    perf_event_attr attr {};
+    attr.size           = sizeof(attr);
+    attr.type           = type;
+    attr.config         = config;
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1; // allowed at perf_event_paranoid <= 2
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0)); // NOLINT
+}
+
+static constexpr uint64_t cache_event(uint64_t cache, uint64_t op, uint64_t result)
+    { return cache | (op << 8) | (result << 16); }
+#endif
+
+perf_counters::perf_counters() {
+    _fds.fill(-1);
+#if defined(__linux__)
+    _fds[cycles]        = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    _fds[instructions]  = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    _fds[branch_misses] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    _fds[l1d_misses]    = open_event(PERF_TYPE_HW_CACHE,
+        cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                    PERF_COUNT_HW_CACHE_RESULT_MISS));
+    _fds[llc_misses]    = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    if (!available()) _error = std::string("perf_event_open: ") + std::strerror(errno);
+#else
+    _error = "perf events are only supported on Linux";
+#endif
+}
+
+perf_counters::~perf_counters() {
+#if defined(__linux__)
+    for (int fd : _fds) if (fd >= 0) close(fd);
+#endif
+}
+
+bool perf_counters::available() const noexcept {
+    for (int fd : _fds) if (fd >= 0) return true;
+    return false;
+}
+
+void perf_counters::start() {
+#if defined(__linux__)
+    for (int fd : _fds) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET,  0); // NOLINT
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0); // NOLINT
+    }
+#endif
+}
+
+perf_counters::reading perf_counters::stop() {
+    reading r {};
+#if defined(__linux__)
+    for (int fd : _fds) if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0); // NOLINT
+    for (size_t e = 0; e < event::count; e++) {
+        if (_fds[e] < 0) continue;
+        uint64_t buf[3]; // value, time enabled, time running
+        if (read(_fds[e], buf, sizeof(buf)) != sizeof(buf) || buf[2] == 0) continue;
+        r[e] = static_cast<double>(buf[0]) * static_cast<double>(buf[1])
+                                           / static_cast<double>(buf[2]);
+    }
+#endif
+    return r;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/// Per-thread hardware counters read through Linux perf_event_open.  Each
+/// event is opened independently, so a machine (or VM) that lacks some of
+/// them still reports the rest; on other systems nothing is ever available.
+struct perf_counters final {
+    enum event : size_t { cycles, instructions, branch_misses, l1d_misses, llc_misses, count };
+    using reading = std::array<std::optional<double>, event::count>;
+
+    perf_counters();
+    ~perf_counters();
+    perf_counters(perf_counters const&) = delete;
+    perf_counters& operator=(perf_counters const&) = delete;
+
+    [[nodiscard]] bool available() const noexcept;
+    /// Why no counter could be opened, empty if at least one was.
+    [[nodiscard]] std::string const& error() const noexcept { return _error; }
+
+    void    start();
+    /// Counts since start(), scaled up if the kernel multiplexed the counters.
+    reading stop();
+
+private:
+    std::array<int, event::count> _fds {};
+    std::string _error;
+};
@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <climits>
+#include <cstddef>
+
+// Build with -DFINITESETS_ALLOC_STATS=1 (CMake option of the same name) to
+// collect statistics.  When off, every hook below is an empty inline function
+// and the per-instance tracker is an empty [[no_unique_address]] member.
+#if !defined(FINITESETS_ALLOC_STATS)
+#define FINITESETS_ALLOC_STATS 0
+#endif
+
+/// Allocation counters, either process-wide or for a single bitvec.
+struct alloc_counters final {
+    // --- events, cleared by reset ---
+    size_t mallocs         = 0;
+    size_t reallocs        = 0;
+    size_t frees           = 0;
+    size_t bytes_allocated = 0; ///< total size requested by malloc and growing reallocs
+    size_t bytes_copied    = 0; ///< by copy-assignment
+    // --- live figures ---
+    size_t live_bytes      = 0;
+    size_t len_bits        = 0;
+    size_t cap_bits        = 0;
+
+    [[nodiscard]] size_t slack_bits() const noexcept { return cap_bits - len_bits; }
+};
+
+/// Process-wide totals over every bitvec.
+struct alloc_stats final {
+    static constexpr bool enabled = FINITESETS_ALLOC_STATS != 0;
+
+    [[nodiscard]] static alloc_counters snapshot() noexcept {
+        auto& g = global();
+        auto ld = [](std::atomic<size_t> const& a) { return a.load(std::memory_order_relaxed); };
+        return { .mallocs = ld(g.mallocs), .reallocs = ld(g.reallocs), .frees = ld(g.frees),
+                 .bytes_allocated = ld(g.bytes_allocated), .bytes_copied = ld(g.bytes_copied),
+                 .live_bytes = ld(g.live_bytes), .len_bits = ld(g.len_bits),
+                 .cap_bits = ld(g.cap_bits) };
+    }
+    /// Clears the event counters.  Live figures keep describing the vectors
+    /// that still exist.
+    static void reset() noexcept {
+        auto& g = global();
+        for (auto* a : {&g.mallocs, &g.reallocs, &g.frees, &g.bytes_allocated, &g.bytes_copied})
+            a->store(0, std::memory_order_relaxed);
+    }
+
+private:
+    template<bool> friend struct alloc_tracker;
+    struct atomics final {
+        std::atomic<size_t> mallocs, reallocs, frees, bytes_allocated, bytes_copied,
+                            live_bytes, len_bits, cap_bits;
+    };
+    static atomics& global() noexcept { static atomics g {}; return g; }
+    static void add(std::atomic<size_t>& a, size_t v) noexcept
+        { a.fetch_add(v, std::memory_order_relaxed); }
+    static void sub(std::atomic<size_t>& a, size_t v) noexcept
+        { a.fetch_sub(v, std::memory_order_relaxed); }
+};
+
+/// Per-instance statistics, mirrored into the process-wide totals.
+template<bool enabled = alloc_stats::enabled>
+struct alloc_tracker final {
+private:
+    alloc_counters c;
+
+public:
+    [[nodiscard]] alloc_counters snapshot() const noexcept { return c; }
+    void reset() noexcept {
+        c.mallocs = c.reallocs = c.frees = c.bytes_allocated = c.bytes_copied = 0;
+    }
+
+    /// Capacity changed from old_cap to new_cap bits; 0 means no buffer.
+    void on_allocate(size_t old_cap, size_t new_cap) noexcept {
+        auto& g = alloc_stats::global();
+        size_t old_bytes = old_cap / CHAR_BIT, new_bytes = new_cap / CHAR_BIT;
+        if (old_cap == 0)      { c.mallocs++;  alloc_stats::add(g.mallocs, 1); }
+        else if (new_cap == 0) { c.frees++;    alloc_stats::add(g.frees, 1); }
+        else                   { c.reallocs++; alloc_stats::add(g.reallocs, 1); }
+        if (new_bytes > old_bytes && new_cap != 0) {
+            c.bytes_allocated += new_bytes;
+            alloc_stats::add(g.bytes_allocated, new_bytes);
+        }
+        c.live_bytes = new_bytes;
+        c.cap_bits   = new_cap;
+        alloc_stats::sub(g.live_bytes, old_bytes); alloc_stats::add(g.live_bytes, new_bytes);
+        alloc_stats::sub(g.cap_bits,   old_cap);   alloc_stats::add(g.cap_bits,   new_cap);
+    }
+    void on_resize(size_t old_len, size_t new_len) noexcept {
+        auto& g = alloc_stats::global();
+        c.len_bits = new_len;
+        alloc_stats::sub(g.len_bits, old_len); alloc_stats::add(g.len_bits, new_len);
+    }
+    void on_copy(size_t bytes) noexcept {
+        c.bytes_copied += bytes;
+        alloc_stats::add(alloc_stats::global().bytes_copied, bytes);
+    }
+};
+
+template<>
+struct alloc_tracker<false> final {
+    [[nodiscard]] alloc_counters snapshot() const noexcept { return {}; }
+    void reset() noexcept {}
+    void on_allocate(size_t, size_t) noexcept {}
+    void on_resize  (size_t, size_t) noexcept {}
+    void on_copy    (size_t)         noexcept {}
+};
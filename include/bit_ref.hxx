@@ -5,7 +5,7 @@
 template<bitspan_word W> requires (!std::is_const_v<W>)
 struct bit_ref final {
 private:
-    friend bitspan<W>;
+    template<bitspan_word, size_t, typename> friend struct bitspan;
     W*   ptr;
     char min_idx;
 
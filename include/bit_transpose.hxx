@@ -0,0 +1,122 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include "bitspan.hxx"
+#include "forward.hxx"
+
+/// Transposes an 8x8 bit matrix packed into a single word, row r in byte r.
+[[nodiscard]] constexpr uint64_t transpose8x8(uint64_t x) noexcept {
+    uint64_t t;
+    t = (x ^ (x >>  7)) & 0x00AA00AA00AA00AAULL; x ^= t ^ (t <<  7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL; x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL; x ^= t ^ (t << 28);
+    return x;
+}
+
+template<bitspan_word W> requires (!std::is_const_v<W>)
+using bit_block = std::array<W, std::numeric_limits<W>::digits>;
+
+// --- square block kernels ---
+// Recursive block swap: at step j, the off-diagonal j x j sub-blocks of every
+// 2j x 2j block trade places.  Row r of the block is word r, column c is bit c.
+template<bitspan_word W> requires (!std::is_const_v<W>)
+constexpr void _transpose_block_scalar(bit_block<W>& a) noexcept { // NOLINT
+    constexpr size_t bits = std::numeric_limits<W>::digits;
+    W m = W(~W(0)) >> (bits / 2);
+    for (size_t j = bits / 2; j != 0; j >>= 1, m ^= W(m << j)) {
+        for (size_t k = 0; k < bits; k = ((k | j) + 1) & ~j) {
+            W t = W((a[k] >> j) ^ a[k | j]) & m;
+            a[k]     ^= W(t << j);
+            a[k | j] ^= t;
+        }
+    }
+}
+
+#if defined(__AVX2__)
+/// 64x64 kernel: the wide steps (j >= 4) swap four row pairs per instruction,
+/// the last two steps fall back to the scalar loop.
+inline void _transpose_block_avx2(bit_block<uint64_t>& a) noexcept { // NOLINT
+    uint64_t m = 0x00000000FFFFFFFFULL;
+    for (size_t j = 32; j >= 4; j >>= 1, m ^= m << j) {
+        __m256i vm = _mm256_set1_epi64x(static_cast<long long>(m));
+        __m128i sh = _mm_cvtsi32_si128(static_cast<int>(j));
+        for (size_t s = 0; s < 64; s += 2 * j) {
+            for (size_t k = s; k < s + j; k += 4) {
+                auto* px = reinterpret_cast<__m256i*>(&a[k]);
+                auto* py = reinterpret_cast<__m256i*>(&a[k + j]);
+                __m256i x = _mm256_loadu_si256(px), y = _mm256_loadu_si256(py);
+                __m256i t = _mm256_and_si256(_mm256_xor_si256(_mm256_srl_epi64(x, sh), y), vm);
+                _mm256_storeu_si256(px, _mm256_xor_si256(x, _mm256_sll_epi64(t, sh)));
+                _mm256_storeu_si256(py, _mm256_xor_si256(y, t));
+            }
+        }
+    }
+    // m now holds the mask for j == 2
+    for (size_t j = 2; j != 0; j >>= 1, m ^= m << j) {
+        for (size_t k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k]     ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+}
+#endif
+
+/// Transposes a W x W bit block in place.
+template<bitspan_word W> requires (!std::is_const_v<W>)
+constexpr void transpose_block(bit_block<W>& a) noexcept {
+    if constexpr (sizeof(W) == 1) {
+        if (!std::is_constant_evaluated()) {
+            auto packed = transpose8x8(std::bit_cast<uint64_t>(a));
+            a = std::bit_cast<bit_block<W>>(packed);
+            return;
+        }
+    }
+#if defined(__AVX2__)
+    if constexpr (std::numeric_limits<W>::digits == 64) {
+        if (!std::is_constant_evaluated()) {
+            auto& a64 = reinterpret_cast<bit_block<uint64_t>&>(a);
+            return _transpose_block_avx2(a64);
+        }
+    }
+#endif
+    _transpose_block_scalar<W>(a);
+}
+// --- end square block kernels ---
+
+/// Transposes an M x N matrix held as M rows of N bits into N rows of M bits.
+/// All source rows must have the same length N, the destination must have
+/// exactly N rows of length M.  The matrix is processed in W x W blocks, so
+/// each source and destination word is touched exactly once.
+template<bitspan_word W = default_bitspan_word> requires (!std::is_const_v<W>)
+void transpose(std::type_identity_t<std::span<bitspan<W const> const>> src,
+               std::type_identity_t<std::span<bitspan<W      > const>> dst) {
+    constexpr size_t bits = bitspan<W>::bits_per_word;
+    const size_t m = src.size();
+    const size_t n = (m == 0) ? dst.size() : src[0].len();
+    if (dst.size() != n) throw bitspan_length_mismatch();
+    for (auto const& row : src) if (row.len() != n) throw bitspan_length_mismatch();
+    for (auto const& row : dst) if (row.len() != m) throw bitspan_length_mismatch();
+
+    const size_t row_blocks = bitspan<W>::words_for_bitcount_unchecked(m);
+    const size_t col_blocks = bitspan<W>::words_for_bitcount_unchecked(n);
+    bit_block<W> block;
+    for (size_t rb = 0; rb < row_blocks; rb++) {
+        const size_t r0 = rb * bits, rows = std::min(bits, m - r0);
+        for (size_t cb = 0; cb < col_blocks; cb++) {
+            const size_t c0 = cb * bits, cols = std::min(bits, n - c0);
+            for (size_t r = 0; r < rows; r++) block[r] = src[r0 + r].words()[cb];
+            for (size_t r = rows; r < bits; r++) block[r] = 0;
+            transpose_block<W>(block);
+            // Rows of the block past the source's last column are the
+            // transposed junk of unused residual bits, so they are dropped
+            for (size_t c = 0; c < cols; c++) dst[c0 + c].words()[rb] = block[c];
+        }
+    }
+}
@@ -1,16 +1,26 @@
 #pragma once
+#include <algorithm>
 #include <bit>
+#include <concepts>
 #include <cstring>
 #include <limits>
 #include <optional>
 #include <ostream>
+#include <ranges>
 #include <span>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
+#include <vector>
 #include "bit_ref.hxx"
 #include "checked_arith.hxx"
 #include "forward.hxx"
 #include "idx_iter.hxx"
+#include "index_check.hxx"
+#include "word_kernels.hxx"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 struct bitspan_length_mismatch final : std::logic_error
     { bitspan_length_mismatch()     : std::logic_error("bitspan lengths did not match"){}};
@@ -19,32 +29,64 @@ struct bitspan_bitcount_overflow final : std::length_error
 struct bitspan_word_count_overflow final : std::length_error
     { bitspan_word_count_overflow() : std::length_error("overflow calculating word count"){}};
 
-template<bitspan_word W>
+/// Order in which the batched scatters visit their indices.  The
+/// partitioned orders first bucket the indices by 64-byte line or 4 KiB
+/// page region with one counting-sort pass, which pays off once the batch
+/// is large and the span far exceeds the caches and the TLB reach.
+enum class scatter_order { given, by_line, by_page };
+
+/// Indices for the batched operations: any contiguous range of an unsigned
+/// type, such as a std::vector, std::array or std::span.
+template<typename R>
+concept bitspan_index_range = std::ranges::contiguous_range<R> && std::ranges::sized_range<R>
+    && std::unsigned_integral<std::ranges::range_value_t<R>>;
+
+/// A view of len() bits over an array of words.  With a static Ext the
+/// length is part of the type, so word counts, residual masks and the loops
+/// over them are compile-time constants; static spans convert implicitly to
+/// the dynamic form, which every operation accepts.  C is the indexing
+/// policy (see index_check.hxx); spans convert implicitly to the checked
+/// policy, and away from it only through with_check.
+template<bitspan_word W, size_t Ext, typename C>
 struct bitspan final {
+    static_assert(index_check<C>);
 public:
     // --- type associations ---
     using word    = W;
+    using check   = C;
+    using dynamic_t = bitspan<W, std::dynamic_extent, C>;
     using bit_ref = bit_ref<std::remove_const_t<W>>;
     using words_t = bitspan_words<W>;
+    using kernels = word_kernels<std::remove_const_t<W>>;
     template<bool in>  using iter_t     = bitspan_iter<in, std::remove_const_t<W>>;
     template<size_t N> using word_array = std::array<W, N>;
-    template<size_t Ext = std::dynamic_extent> using word_span = std::span<W, Ext>;
+    template<size_t E = std::dynamic_extent> using word_span = std::span<W, E>;
 
-    friend struct bitspan<const W>;
-    friend struct bitspan<std::remove_const_t<W>>;
+    template<bitspan_word, size_t, typename> friend struct bitspan;
     friend words_t;
+    template<bitspan_word U>
+    static constexpr bool same_word = std::is_same_v<std::remove_const_t<U>, std::remove_const_t<W>>;
     // --- end type associations ---
 
     // --- constants ---
     static constexpr size_t bits_per_word = std::numeric_limits<W>::digits;
     static constexpr size_t majshift      = std::bit_width(bits_per_word) - 1;
     static constexpr size_t minmask       = bits_per_word - 1;
+    static constexpr size_t extent        = Ext;
+    static constexpr bool   is_static     = Ext != std::dynamic_extent;
+    /// Fold expressions over word indices are used up to this many words.
+    static constexpr size_t unroll_limit  = 16;
+    /// Batched operations prefetch the word of the index this far ahead.
+    static constexpr size_t prefetch_distance = 16;
+    /// Upper bound on the buckets of a partitioned scatter.
+    static constexpr size_t partition_buckets = 1024;
     // --- end constants ---
 
 private:
     // --- fields ---
-    W*     _base = nullptr;
-    size_t _len  = 0;
+    W* _base = nullptr;
+    [[no_unique_address]] std::conditional_t<is_static,
+        std::integral_constant<size_t, Ext>, size_t> _len {};
     // --- end fields ---
 
 public:
@@ -52,59 +94,223 @@ public:
     [[nodiscard]] static constexpr size_t maj_bi(size_t i) noexcept { return i >> majshift; }
     [[nodiscard]] static constexpr size_t min_bi(size_t i) noexcept { return i &  minmask ; }
     [[nodiscard]] static constexpr size_t bits_in_words(size_t num_words)
-        { return throwing_mul<W, bitspan_bitcount_overflow>(num_words, bits_per_word); }
+        { return throwing_mul<size_t, bitspan_bitcount_overflow>(num_words, bits_per_word); }
     [[nodiscard]] static constexpr size_t words_for_bitcount_unchecked(size_t c) noexcept
         { return maj_bi(c + minmask); }
     [[nodiscard]] static constexpr size_t words_for_bitcount(size_t c)
         { return maj_bi(throwing_add<size_t, bitspan_word_count_overflow>(c, minmask)); }
 
+    static constexpr size_t static_word_count = is_static ? words_for_bitcount(Ext) : 0;
+    /// Calls f(i) for every word index of a static span, as straight-line
+    /// code for short spans and as a constant-trip loop otherwise.
+    template<typename F>
+    static constexpr void _for_each_static_word(F f) requires(is_static) { // NOLINT
+        if constexpr (static_word_count <= unroll_limit)
+            [&]<size_t... I>(std::index_sequence<I...>) { (f(I), ...); }
+                (std::make_index_sequence<static_word_count>());
+        else
+            for (size_t i = 0; i < static_word_count; i++) f(i);
+    }
+
     static constexpr void word_to_chars(char out[bits_per_word], std::remove_const_t<W> word)
     noexcept { for (size_t i = 0; i < bits_per_word; word >>= 1) out[i++] = '0' + (word & 1); }
     // --- end useful expressions ---
 
     // --- constructors ---
-    bitspan(bitspan<std::remove_const_t<W>> o) noexcept
-        : _base(o._base), _len(o._len) {}
+    // Adding const, going from a static extent to the dynamic one, or
+    // changing the indexing policy, implicitly only towards index_checked
+    template<bitspan_word U, size_t E, typename D>
+        requires(same_word<U> && (std::is_const_v<W> || !std::is_const_v<U>)
+                 && (!is_static || E == Ext)
+                 && !(std::is_same_v<U, W> && E == Ext && std::is_same_v<D, C>))
+    explicit(!std::is_same_v<D, C> && !std::is_same_v<C, index_checked>)
+    constexpr bitspan(bitspan<U, E, D> o) noexcept : _base(o._base), _len(o._len) {}
+
+    // Checked narrowing of a dynamic span to a static extent
+    template<bitspan_word U, typename D>
+        requires(is_static && same_word<U> && (std::is_const_v<W> || !std::is_const_v<U>))
+    explicit constexpr bitspan(bitspan<U, std::dynamic_extent, D> o) : _base(o._base)
+        { if (o.len() != Ext) throw bitspan_length_mismatch(); }
 
     // From raw parts
-    explicit bitspan(W* base, size_t len) noexcept : _base(base), _len(len) {}
+    explicit constexpr bitspan(W* base, size_t len) noexcept requires(!is_static)
+        : _base(base), _len(len) {}
+    explicit constexpr bitspan(W* base) noexcept requires(is_static) : _base(base) {}
 
-    template<size_t E>
+    template<size_t E> requires(!is_static)
     bitspan(std::span<W, E> a) : _base(a.data()), _len(bits_in_words(a.size())) {}
+    template<size_t E> requires(is_static && E == static_word_count)
+    constexpr bitspan(std::span<W, E> a) noexcept : _base(a.data()) {}
 
-    template<size_t N>
-    bitspan(std::array<W, N>& a) : bitspan(std::span(a)) {}
-    template<size_t N>
-    bitspan(std::array<W, N> const& a) requires(std::is_const_v<W>)
-        : bitspan(std::span(a)) {}
+    template<size_t N> requires(!is_static || N == static_word_count)
+    constexpr bitspan(std::array<W, N>& a) : bitspan(std::span<W, N>(a)) {}
+    template<size_t N> requires(std::is_const_v<W> && (!is_static || N == static_word_count))
+    constexpr bitspan(std::array<std::remove_const_t<W>, N> const& a)
+        : bitspan(std::span<W, N>(a)) {}
 
     // --- end constructors ---
 
     // --- accessors ---
-    [[nodiscard]] size_t len() const noexcept { return _len; }
-    size_t truncate(size_t len) noexcept { return _len = std::min(len, _len); }
+    [[nodiscard]] constexpr size_t len() const noexcept { return _len; }
+    size_t truncate(size_t len) noexcept requires(!is_static) { return _len = std::min(len, _len); }
+    [[nodiscard]] constexpr dynamic_t dynamic() const noexcept { return *this; }
+    /// The same bits under the indexing policy D.
+    template<typename D>
+    [[nodiscard]] constexpr bitspan<W, Ext, D> with_check() const noexcept
+        { return bitspan<W, Ext, D>(*this); }
     // --- end accessors ---
 
     // --- misc utilities ---
-    [[nodiscard]] bitspan<const W> to_const() const noexcept { return *this; }
-    template<bitspan_word O>
-    void ensure_ge_length(bitspan<O> o) const
-        { if (_len < o._len) throw bitspan_length_mismatch(); }
-    [[nodiscard]] size_t residual_bitcount() const noexcept { return _len & minmask; }
-    [[nodiscard]] W residual_mask() const noexcept { return (1 << residual_bitcount()) - 1; }
+    [[nodiscard]] constexpr bitspan<const W, Ext, C> to_const() const noexcept { return *this; }
+    template<bitspan_word O, size_t E, typename D>
+    void ensure_ge_length(bitspan<O, E, D> o) const
+        { if (len() < o.len()) throw bitspan_length_mismatch(); }
+    [[nodiscard]] constexpr size_t residual_bitcount() const noexcept { return _len & minmask; }
+    [[nodiscard]] constexpr std::remove_const_t<W> residual_mask() const noexcept
+        { return (W(1) << residual_bitcount()) - 1; }
     // --- end misc utilities ---
 
     /// --- indexing ---
     [[nodiscard]] bool    operator[](size_t i) const requires( std::is_const_v<W>) {
-        if (i > _len) throw std::out_of_range("bitspan index out of range");
-        return (_base[maj_bi(i)] >> min_bi(i)) & 1;
+        C::check(i, len());
+        return test_unchecked(i);
     }
     [[nodiscard]] bit_ref operator[](size_t i) const requires(!std::is_const_v<W>) {
-        if (i > _len) throw std::out_of_range("bitspan index out of range");
+        C::check(i, len());
         return bit_ref(*this, i);
     }
+    // Whatever the policy, these never check i
+    [[nodiscard]] constexpr bool test_unchecked(size_t i) const noexcept
+        { return (_base[maj_bi(i)] >> min_bi(i)) & 1; }
+    constexpr bitspan set_unchecked(size_t i, bool val = true) const noexcept // NOLINT yesdiscard
+    requires(!std::is_const_v<W>) {
+        auto& w = _base[maj_bi(i)];
+        w = (w & ~(W(1) << min_bi(i))) | (W(val) << min_bi(i));
+        return *this;
+    }
     /// --- end indexing ---
 
+    /// --- batched indexing ---
+    // The batch is checked once up front, through its largest index; each
+    // word update is then issued with the word of the index
+    // prefetch_distance positions later already in flight, so the cache
+    // misses overlap instead of serializing.
+    template<std::unsigned_integral I>
+    void _ensure_indices(std::span<I const> idx) const { // NOLINT
+        if constexpr (std::is_same_v<C, index_unchecked>) return;
+        I hi = 0;
+        for (I i : idx) hi = std::max(hi, i);
+        if (!idx.empty()) C::check(size_t(hi), len());
+    }
+    template<bitspan_index_range R>
+    [[nodiscard]] static auto _index_span(R const& idx) noexcept // NOLINT
+        { return std::span<std::ranges::range_value_t<R> const>(std::ranges::data(idx), std::ranges::size(idx)); }
+    /// The indices reordered by region of 2^shift bits, the regions being
+    /// coarsened until there are at most partition_buckets of them.
+    template<std::unsigned_integral I>
+    [[nodiscard]] std::vector<I> _partition_indices(std::span<I const> idx, size_t shift) const { // NOLINT
+        while ((len() >> shift) >= partition_buckets) shift++;
+        std::vector<size_t> starts((len() >> shift) + 2, 0);
+        for (I i : idx) starts[(size_t(i) >> shift) + 1]++;
+        for (size_t b = 1; b < starts.size(); b++) starts[b] += starts[b - 1];
+        std::vector<I> rslt(idx.size());
+        for (I i : idx) rslt[starts[size_t(i) >> shift]++] = i;
+        return rslt;
+    }
+    template<std::unsigned_integral I, typename F>
+    void _scatter(std::span<I const> idx, scatter_order order, F f) const // NOLINT
+    requires(!std::is_const_v<W>) {
+        _ensure_indices(idx);
+        std::vector<I> partitioned;
+        if (order != scatter_order::given) {
+            partitioned = _partition_indices(idx, order == scatter_order::by_line ? 9 : 15);
+            idx = partitioned;
+        }
+        for (size_t k = 0; k < idx.size(); k++) {
+            if (k + prefetch_distance < idx.size())
+                __builtin_prefetch(_base + maj_bi(idx[k + prefetch_distance]), 1);
+            f(_base[maj_bi(idx[k])], W(W(1) << min_bi(idx[k])));
+        }
+    }
+
+    /// Sets, clears or flips the bit at every index in idx.  Repeated
+    /// indices are allowed; for flip_many each occurrence flips once.
+    template<bitspan_index_range R>
+    bitspan set_many(R const& idx, scatter_order order = scatter_order::given) const // NOLINT yesdiscard
+    requires(!std::is_const_v<W>)
+        { _scatter(_index_span(idx), order, [](W& w, W bit) { w |= bit; }); return *this; }
+    template<bitspan_index_range R>
+    bitspan reset_many(R const& idx, scatter_order order = scatter_order::given) const // NOLINT yesdiscard
+    requires(!std::is_const_v<W>)
+        { _scatter(_index_span(idx), order, [](W& w, W bit) { w &= ~bit; }); return *this; }
+    template<bitspan_index_range R>
+    bitspan flip_many(R const& idx, scatter_order order = scatter_order::given) const // NOLINT yesdiscard
+    requires(!std::is_const_v<W>)
+        { _scatter(_index_span(idx), order, [](W& w, W bit) { w ^= bit; }); return *this; }
+
+    /// Whether _test8 loads its 8 words with one AVX2 gather of 32-bit
+    /// lanes, which needs 32-bit indices and words no narrower than a lane.
+    template<std::unsigned_integral I>
+    static constexpr bool _gathers = // NOLINT
+#if defined(__AVX2__)
+        sizeof(I) == 4 && sizeof(W) >= 4;
+#else
+        false;
+#endif
+    /// Bit k of the result is the bit at p[k], for k < 8.
+    template<std::unsigned_integral I>
+    [[nodiscard]] unsigned _test8(I const* p) const noexcept { // NOLINT
+#if defined(__AVX2__)
+        if constexpr (_gathers<I>) {
+            __m256i i = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+            __m256i w = _mm256_i32gather_epi32(reinterpret_cast<int const*>(_base),
+                                               _mm256_srli_epi32(i, 5), 4);
+            __m256i b = _mm256_srlv_epi32(w, _mm256_and_si256(i, _mm256_set1_epi32(31)));
+            return unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(b, 31))));
+        }
+#endif
+        unsigned rslt = 0;
+        for (size_t k = 0; k < 8; k++) rslt |= unsigned(test_unchecked(p[k])) << k;
+        return rslt;
+    }
+    /// Calls emit(k, bits) for k = 0, 8, 16, ... with the results for
+    /// idx[k .. k + 8) packed LSB-first, the final group zero-padded.
+    template<std::unsigned_integral I, typename F>
+    void _gather(std::span<I const> idx, F emit) const { // NOLINT
+        _ensure_indices(idx);
+        size_t n = idx.size(), k = 0;
+        for (; k + 8 <= n; k += 8) {
+            // A gather already has its 8 loads in flight together
+            if constexpr (!_gathers<I>)
+                for (size_t j = k + prefetch_distance; j < std::min(n, k + prefetch_distance + 8); j++)
+                    __builtin_prefetch(_base + maj_bi(idx[j]), 0);
+            emit(k, _test8(idx.data() + k));
+        }
+        unsigned tail = 0;
+        for (size_t j = k; j < n; j++) tail |= unsigned(test_unchecked(idx[j])) << (j - k);
+        if (k < n) emit(k, tail);
+    }
+
+    /// Bit k of out becomes the bit at idx[k]; out must be idx.size() long.
+    template<bitspan_index_range R>
+    void test_many(R const& idx, bitspan<std::remove_const_t<W>> out) const {
+        if (out.len() != std::ranges::size(idx)) throw bitspan_length_mismatch();
+        _gather(_index_span(idx), [&](size_t k, unsigned bits) {
+            auto& w = out._base[maj_bi(k)];
+            w = min_bi(k) == 0 ? W(bits) : W(w | W(bits) << min_bi(k));
+        });
+    }
+    /// out[k] becomes 1 if the bit at idx[k] is set and 0 otherwise.
+    template<bitspan_index_range R>
+    void test_many(R const& idx, std::span<uint8_t> out) const {
+        size_t n = std::ranges::size(idx);
+        if (out.size() != n) throw bitspan_length_mismatch();
+        _gather(_index_span(idx), [&](size_t k, unsigned bits) {
+            for (size_t j = 0; j < std::min<size_t>(8, n - k); j++) out[k + j] = (bits >> j) & 1;
+        });
+    }
+    /// --- end batched indexing ---
+
     /// --- bulk bitwise operations ---
     bool operator ==(bitspan<W const> o) const noexcept {
         if (_len != o._len) return false;
@@ -132,23 +338,27 @@ public:
         for (auto i : word_indices()) _base[i] = ~_base[i];
         return *this;
     }
+    bitspan clear_residual() const noexcept requires(!std::is_const_v<W>) { // NOLINT yesdiscard
+        if (residual_bitcount() != 0) _base[words().count() - 1] &= residual_mask();
+        return *this;
+    }
     bitspan operator &=(bitspan<const W> o) const requires(!std::is_const_v<W>) {
         ensure_ge_length(o);
-        size_t main_loop_words = words().count();
+        size_t main_loop_words = o.words().count();
         if (o.residual_bitcount() != 0) main_loop_words--;
         for (size_t i = 0; i < main_loop_words; i++) _base[i] &= o._base[i];
         if (o.residual_bitcount() != 0) {
             W resmask = o.residual_mask();
             size_t residx = o.words().count() - 1;
             _base[residx] &= o._base[residx] & resmask;
-            // Zero-extend the smaller operand
-            _reset_word_range(o.words().count(), words().count());
         }
+        // Zero-extend the smaller operand
+        _reset_word_range(o.words().count(), words().count());
         return *this;
     }
     bitspan operator |=(bitspan<const W> o) const requires(!std::is_const_v<W>) {
         ensure_ge_length(o);
-        size_t main_loop_words = words().count();
+        size_t main_loop_words = o.words().count();
         if (o.residual_bitcount() != 0) main_loop_words--;
         for (size_t i = 0; i < main_loop_words; i++) _base[i] |= o._base[i];
         if (o.residual_bitcount() != 0) {
@@ -160,7 +370,7 @@ public:
     }
     bitspan operator ^=(bitspan<const W> o) const requires(!std::is_const_v<W>) {
         ensure_ge_length(o);
-        size_t main_loop_words = words().count();
+        size_t main_loop_words = o.words().count();
         if (o.residual_bitcount() != 0) main_loop_words--;
         for (size_t i = 0; i < main_loop_words; i++) _base[i] ^= o._base[i];
         if (o.residual_bitcount() != 0) {
@@ -170,32 +380,148 @@ public:
         }
         return *this;
     }
+    bitspan and_not(bitspan<const W> o) const requires(!std::is_const_v<W>) { // NOLINT
+        ensure_ge_length(o);
+        size_t main_loop_words = o.words().count();
+        if (o.residual_bitcount() != 0) main_loop_words--;
+        for (size_t i = 0; i < main_loop_words; i++) _base[i] &= ~o._base[i];
+        if (o.residual_bitcount() != 0) {
+            W resmask = o.residual_mask();
+            size_t residx = o.words().count() - 1;
+            _base[residx] &= ~(o._base[residx] & resmask);
+        }
+        return *this;
+    }
     bitspan set_from(bitspan<const W> o) const requires(!std::is_const_v<W>) { // NOLINT
         ensure_ge_length(o);
-        size_t main_loop_words = words().count();
+        size_t main_loop_words = o.words().count();
         if (o.residual_bitcount() != 0) main_loop_words--;
         for (size_t i = 0; i < main_loop_words; i++) _base[i] = o._base[i];
         if (o.residual_bitcount() != 0) {
             W resmask = o.residual_mask();
             size_t residx = o.words().count() - 1;
             _base[residx] = o._base[residx] & resmask;
-            // Zero-extend the smaller operand
-            _reset_word_range(o.words().count(), words().count());
         }
+        // Zero-extend the smaller operand
+        _reset_word_range(o.words().count(), words().count());
         return *this;
     }
     /// --- end bulk bitwise operations ---
 
+    /// --- static-extent bulk operations ---
+    // Both lengths are fixed by the type and equal, so there is no length
+    // check or zero-extension, and each loop has a constant trip count.
+    template<bitspan_word U> requires(is_static && same_word<U>)
+    [[nodiscard]] constexpr bool operator ==(bitspan<U, Ext> o) const noexcept {
+        std::remove_const_t<W> diff = 0;
+        _for_each_static_word([&](size_t i) {
+            auto d = _base[i] ^ o._base[i];
+            if (i == static_word_count - 1 && residual_bitcount() != 0) d &= residual_mask();
+            diff |= d;
+        });
+        return diff == 0;
+    }
+    template<bitspan_word U> requires(is_static && same_word<U> && !std::is_const_v<W>)
+    constexpr bitspan operator &=(bitspan<U, Ext> o) const noexcept
+        { _for_each_static_word([&](size_t i) { _base[i] &= o._base[i]; }); return *this; }
+    template<bitspan_word U> requires(is_static && same_word<U> && !std::is_const_v<W>)
+    constexpr bitspan operator |=(bitspan<U, Ext> o) const noexcept
+        { _for_each_static_word([&](size_t i) { _base[i] |= o._base[i]; }); return *this; }
+    template<bitspan_word U> requires(is_static && same_word<U> && !std::is_const_v<W>)
+    constexpr bitspan operator ^=(bitspan<U, Ext> o) const noexcept
+        { _for_each_static_word([&](size_t i) { _base[i] ^= o._base[i]; }); return *this; }
+    template<bitspan_word U> requires(is_static && same_word<U> && !std::is_const_v<W>)
+    constexpr bitspan and_not(bitspan<U, Ext> o) const noexcept // NOLINT yesdiscard
+        { _for_each_static_word([&](size_t i) { _base[i] &= ~o._base[i]; }); return *this; }
+    template<bitspan_word U> requires(is_static && same_word<U> && !std::is_const_v<W>)
+    constexpr bitspan set_from(bitspan<U, Ext> o) const noexcept // NOLINT yesdiscard
+        { _for_each_static_word([&](size_t i) { _base[i] = o._base[i]; }); return *this; }
+    /// --- end static-extent bulk operations ---
+
+    /// --- set predicates ---
+    // Operands are zero-extended to the longer length.  Whole words shared by
+    // both go through the fused kernels, which stop at the first witness word;
+    // the partial last word and the longer operand's excess are checked after.
+    [[nodiscard]] std::remove_const_t<W> _word_or_zero(size_t i) const noexcept { // NOLINT
+        size_t count = words().count();
+        if (i >= count) return 0;
+        if (i == count - 1 && residual_bitcount() != 0) return _base[i] & residual_mask();
+        return _base[i];
+    }
+    [[nodiscard]] bool _any_from_word(size_t start) const noexcept { // NOLINT
+        size_t full = len() >> majshift;
+        if (start < full && kernels::any(_base + start, full - start)) return true;
+        return _word_or_zero(std::max(start, full)) != 0;
+    }
+    template<typename Op>
+    [[nodiscard]] bool _any_common(bitspan<const W> o) const noexcept { // NOLINT
+        size_t full   = std::min(len(), o.len()) >> majshift;
+        size_t common = std::min(words().count(), o.words().count());
+        if (kernels::template any<Op>(_base, o._base, full)) return true;
+        for (size_t i = full; i < common; i++)
+            if (Op::apply(_word_or_zero(i), o._word_or_zero(i)) != 0) return true;
+        return false;
+    }
+
+    [[nodiscard]] bool any () const noexcept { return  _any_from_word(0); }
+    [[nodiscard]] bool none() const noexcept { return !_any_from_word(0); }
+    [[nodiscard]] bool intersects(bitspan<const W> o) const noexcept
+        { return _any_common<word_op_and>(o); }
+    [[nodiscard]] bool is_disjoint(bitspan<const W> o) const noexcept
+        { return !intersects(o); }
+    [[nodiscard]] bool is_subset_of(bitspan<const W> o) const noexcept {
+        if (_any_common<word_op_andnot>(o)) return false;
+        return !_any_from_word(o.words().count());
+    }
+    [[nodiscard]] bool is_superset_of(bitspan<const W> o) const noexcept
+        { return o.is_subset_of(*this); }
+    [[nodiscard]] bool equals_ignoring_length(bitspan<const W> o) const noexcept {
+        if (_any_common<word_op_xor>(o)) return false;
+        size_t common = std::min(words().count(), o.words().count());
+        return !_any_from_word(common) && !o._any_from_word(common);
+    }
+    /// --- end set predicates ---
+
+    /// --- counting ---
+    // Same zero-extension and word split as the set predicates above.
+    [[nodiscard]] size_t _count_from_word(size_t start) const noexcept { // NOLINT
+        size_t full = len() >> majshift, total = 0;
+        if (start < full) total = kernels::count(_base + start, full - start);
+        return total + std::popcount(_word_or_zero(std::max(start, full)));
+    }
+    template<typename Op>
+    [[nodiscard]] size_t _count_common(bitspan<const W> o) const noexcept { // NOLINT
+        size_t full   = std::min(len(), o.len()) >> majshift;
+        size_t common = std::min(words().count(), o.words().count());
+        size_t total  = kernels::template count<Op>(_base, o._base, full);
+        for (size_t i = full; i < common; i++)
+            total += std::popcount(Op::apply(_word_or_zero(i), o._word_or_zero(i)));
+        return total;
+    }
+
+    [[nodiscard]] size_t count() const noexcept { return _count_from_word(0); }
+    [[nodiscard]] size_t count_and(bitspan<const W> o) const noexcept
+        { return _count_common<word_op_and>(o); }
+    [[nodiscard]] size_t count_andnot(bitspan<const W> o) const noexcept {
+        size_t common = std::min(words().count(), o.words().count());
+        return _count_common<word_op_andnot>(o) + _count_from_word(common);
+    }
+    [[nodiscard]] size_t count_or(bitspan<const W> o) const noexcept {
+        size_t common = std::min(words().count(), o.words().count());
+        return _count_common<word_op_or>(o) + _count_from_word(common) + o._count_from_word(common);
+    }
+    [[nodiscard]] size_t count_xor(bitspan<const W> o) const noexcept {
+        size_t common = std::min(words().count(), o.words().count());
+        return _count_common<word_op_xor>(o) + _count_from_word(common) + o._count_from_word(common);
+    }
+    /// --- end counting ---
+
     /// --- helper constructors ---
     [[nodiscard]] words_t words       () const noexcept { return {*this}; }
-    [[nodiscard]] indices bit_indices () const noexcept { return indices(_len); }
+    [[nodiscard]] indices bit_indices () const noexcept { return indices(len()); }
     [[nodiscard]] indices word_indices() const noexcept { return indices(words().count()); }
     template<bool in>
-    [[nodiscard]] iter_t<in> iter() const noexcept
-        { return { .span = *this,
-                 .idx = 0,
-                 .current = 0,
-                 .cur_idx = bits_per_word }; }
+    [[nodiscard]] iter_t<in> iter() const noexcept { return iter_t<in>(*this); }
 
     /// --- end helper constructors ---
 };
@@ -203,8 +529,7 @@ public:
 template<bool in, bitspan_word W> requires (!std::is_const_v<W>)
 struct bitspan_iter final {
 private:
-    friend struct bitspan<      W>;
-    friend struct bitspan<const W>;
+    template<bitspan_word, size_t, typename> friend struct bitspan;
 
     bitspan<const W> span;
     size_t           idx;
@@ -218,20 +543,26 @@ public:
     bitspan_iter() = delete;
 
     std::optional<size_t> next() noexcept {
+        constexpr size_t bits = bitspan<W>::bits_per_word;
         while (current == 0) {
-            idx += bitspan<W>::bits_per_word - cur_idx;
-            cur_idx = bitspan<W>::bits_per_word;
-            if (idx > span.len()) return std::nullopt;
-            current = span.words().of_bit(idx) ^ ((in) ? 0 : ~0);
+            idx += bits - cur_idx;
+            cur_idx = bits;
+            if (idx >= span.len()) return std::nullopt;
+            current = span.words().of_bit(idx) ^ ((in) ? W(0) : W(~W(0)));
             cur_idx = 0;
         }
         // There can't not be a bit set to 1 in current by this point, so the
         // below figure cannot be greater than the remaining number of bits
         // to process in current
         char shift = std::countr_zero(current) + 1;
-        current  >>= shift;
-        cur_idx   += shift;
-        idx       += shift;
+        current  = (size_t(shift) < bits) ? W(current >> shift) : W(0);
+        cur_idx += shift;
+        idx     += shift;
+        // Bits past the end of the span in its last word are not part of it
+        if (idx > span.len()) {
+            current = 0; cur_idx = bits; idx = span.len();
+            return std::nullopt;
+        }
         return std::make_optional(idx - 1);
     }
 };
@@ -239,7 +570,7 @@ public:
 template<bitspan_word W>
 struct bitspan_words final {
 private:
-    friend bitspan<W>;
+    template<bitspan_word, size_t, typename> friend struct bitspan;
     friend bitspan_words<const W>;
     friend bitspan_words<std::remove_const_t<W>>;
     bitspan<W> span;
@@ -260,8 +591,8 @@ public:
         { return begin()[bitspan<W>::maj_bi(i)]; }
 };
 
-template<bitspan_word W>
-std::ostream& operator<<(std::ostream& o, bitspan<W> b) {
+template<bitspan_word W, size_t Ext, typename C>
+std::ostream& operator<<(std::ostream& o, bitspan<W, Ext, C> b) {
     char buf[bitspan<W>::bits_per_word];
     size_t end = b.len() >> bitspan<W>::majshift;
     for (size_t i = 0; i < end; i++) {
@@ -280,6 +611,7 @@ std::ostream& operator<<(std::ostream& o, bitspan<W> b) {
 
 /// --- explicit instantiation ---
 template struct bitspan<>;
+template struct bitspan<default_bitspan_word, std::dynamic_extent, index_unchecked>;
 template struct bitspan_iter<false>;
 template struct bitspan_iter<true>;
 /// --- end explicit instantiation ---
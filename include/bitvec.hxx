@@ -1,19 +1,28 @@
 #pragma once
 #include <cstdlib>
 #include <cstring>
+#include <utility>
 #include <vector>
+#include "alloc_stats.hxx"
 #include "bitspan.hxx"
+#include "bitvec_alloc.hxx"
 #include "forward.hxx"
 
-template<bitspan_word W> requires (!std::is_const_v<W>)
+/// Growable bit vector owning its words, which come from the storage
+/// policy A (see bitvec_alloc.hxx).  Indexing, and the spans from span(),
+/// follow the indexing policy C (see index_check.hxx).
+template<bitspan_word W, typename A, typename C> requires (!std::is_const_v<W>)
 struct bitvec final {
+    static_assert(bitvec_alloc<A>);
 public:
     // --- type associations ---
     using word        = W;
+    using alloc       = A;
+    using check       = C;
     using word_vector = std::vector<W>;
-    using const_span  = bitspan<W const>;
-    using mut_span    = bitspan<W>;
-    template<bool mut> using words_t    = bitvec_words<mut, W>;
+    using const_span  = bitspan<W const, std::dynamic_extent, C>;
+    using mut_span    = bitspan<W,       std::dynamic_extent, C>;
+    template<bool mut> using words_t    = bitvec_words<mut, W, A, C>;
     template<size_t N> using word_array = std::array<W, N>;
     template<bool in>  using iter_t     = bitspan_iter<in, W>;
     template<size_t Ext = std::dynamic_extent> using word_span = std::span<W, Ext>;
@@ -27,6 +36,27 @@ public:
     static constexpr size_t majshift      = const_span::majshift;
     static constexpr size_t minmask       = const_span::minmask;
     static constexpr size_t min_cap       = const_span::bits_in_words(128 / sizeof(W));
+    static constexpr size_t alignment     = A::alignment;
+    /// Largest capacity the storage policy can provide.
+    static constexpr size_t max_cap = [] {
+        if constexpr (requires { A::max_bytes; }) return (A::max_bytes / sizeof(W)) * bits_per_word;
+        else return SIZE_MAX;
+    }();
+    /// Whether the policy can hand out zero-filled buffers, and whether
+    /// growth zero-fills the bytes past the old size.
+    static constexpr bool allocates_zeroed = [] {
+        if constexpr (requires { A::allocate_zeroed(size_t()); }) return true;
+        else if constexpr (requires { A::allocates_zeroed; }) return A::allocates_zeroed;
+        else return false;
+    }();
+    static constexpr bool grows_zeroed = [] {
+        if constexpr (requires { A::grows_zeroed; }) return A::grows_zeroed;
+        else return false;
+    }();
+    /// With both, the words between the length and the capacity are kept
+    /// zero, by clearing them when the vector shrinks, so growing never has
+    /// to write them.
+    static constexpr bool tail_zeroed = allocates_zeroed && grows_zeroed;
     // --- end constants ---
 
     // --- useful expressions ---
@@ -43,22 +73,40 @@ private:
     W*     _base = nullptr;
     size_t _len  = 0;
     size_t _cap  = 0;
+    [[no_unique_address]] alloc_tracker<> _stats;
     // --- end fields ---
 
     // --- memory management helpers ---
     void deallocate() {
         if (_cap == 0) return;
+        _stats.on_allocate(_cap, 0);
+        A::deallocate(_base, bytes_for_bitcount_unchecked(_cap));
         _cap = 0;
-        free(_base); // NOLINT
         _base = nullptr;
     }
-    void reallocate(size_t bits) {
+    void clear_words(size_t from, size_t to) noexcept {
+        if (from >= to) return;
+        if constexpr (requires { A::discard(_base, from, to); })
+            A::discard(_base, from * sizeof(W), to * sizeof(W));
+        else
+            memset(_base + from, 0, (to - from) * sizeof(W));
+    }
+    [[nodiscard]] static void* allocate(size_t bytes, bool zeroed) noexcept {
+        if constexpr (requires { A::allocate_zeroed(bytes); })
+            if (zeroed) return A::allocate_zeroed(bytes);
+        return A::allocate(bytes);
+    }
+    // A fresh buffer is zero-filled where the policy can do so cheaply,
+    // unless the caller is about to overwrite all of it.
+    void reallocate(size_t bits, bool zeroed = true) {
         if (bits == 0) return deallocate();
         auto words = const_span::words_for_bitcount(bits);
         auto bytes = throwing_mul<size_t, std::bad_array_new_length>(words, sizeof(W));
-        auto new_ptr = (_cap != 0) ? realloc(_base, bytes) : malloc(bytes); // NOLINT
+        auto new_ptr = (_cap != 0) ? A::reallocate(_base, bytes_for_bitcount_unchecked(_cap), bytes)
+                                   : allocate(bytes, zeroed);
         if (new_ptr == nullptr) throw std::bad_alloc();
         _base = static_cast<W*>(new_ptr);
+        _stats.on_allocate(_cap, const_span::bits_in_words(words));
         _cap = const_span::bits_in_words(words);
     }
     // --- end memory management helpers ---
@@ -68,20 +116,25 @@ public:
     bitvec() noexcept = default;
     bitvec& operator=(bitvec const& o) {
         if (this == &o) return *this;
-        reserve_for_exact(o._len);
+        // Every word of an exact-size fresh buffer is copied over
+        if (_cap < o._len) reallocate(o._len, false);
+        if constexpr (tail_zeroed) clear_words(o.words().count(), words().count());
         memcpy(_base, o._base, o.words().count() * sizeof(W));
+        _stats.on_copy(o.words().count() * sizeof(W));
+        _stats.on_resize(_len, o._len);
         _len = o._len;
         return *this;
     }
     bitvec(bitvec const& o) : bitvec() { *this = o; }
     explicit bitvec(size_t len) : bitvec() { resize(len); }
 
-    bitvec(bitvec&& o) noexcept : _base(o._base), _len(o._len), _cap(o._cap)
+    bitvec(bitvec&& o) noexcept
+        : _base(o._base), _len(o._len), _cap(o._cap), _stats(std::exchange(o._stats, {}))
         { o._base = nullptr; o._len = o._cap = 0; }
     bitvec& operator=(bitvec&& o) noexcept
         { if (this != &o) { this->~bitvec(); new(this) bitvec(std::move(o)); } return *this; }
 
-    ~bitvec() { if (_cap != 0) free(_base); } // NOLINT
+    ~bitvec() { _stats.on_resize(_len, 0); deallocate(); }
     // --- end constructors and rule of five ---
 
     // --- memory management ---
@@ -90,17 +143,27 @@ public:
         return _cap;
     }
     size_t reserve_for(size_t new_cap) {
+        if (new_cap <= _cap) return _cap;
         auto amort_siz = (_len << 1 >= _len) ? _len << 1 : SIZE_MAX;
-        return reserve_for_exact(std::max(amort_siz, new_cap));
+        return reserve_for_exact(std::max(std::min(amort_siz, max_cap), new_cap));
     }
     size_t resize(size_t new_len) {
+        bool fresh = _cap == 0;
         reserve_for(new_len);
+        auto new_wordcnt = const_span::words_for_bitcount_unchecked(new_len);
         if (new_len > _len) {
-            auto new_wordcnt = const_span::words_for_bitcount_unchecked(new_len);
-            memset(words().end(), 0, (new_wordcnt - words().count()) * sizeof(W));
+            // Bits past the old length may be garbage and are about to be
+            // exposed.  Whole words need no clearing when they are known to
+            // be zero, so large zeroed storage stays untouched until written.
+            span().clear_residual();
+            if (!tail_zeroed && !(fresh && allocates_zeroed))
+                memset(words().end(), 0, (new_wordcnt - words().count()) * sizeof(W));
+        } else if constexpr (tail_zeroed) {
+            clear_words(new_wordcnt, words().count());
         }
+        _stats.on_resize(_len, new_len);
         _len = new_len;
-        if (new_len != 0) *(words().end() - 1) &= (1 << const_span::min_bi(new_len)) - 1;
+        span().clear_residual();
         return new_len;
     }
     // --- end memory management ---
@@ -108,7 +171,14 @@ public:
     // --- accessors ---
     [[nodiscard]] size_t len() const noexcept { return _len; }
     [[nodiscard]] size_t cap() const noexcept { return _cap; }
-    size_t truncate(size_t len) noexcept { return _len = std::min(len, _len); }
+    size_t truncate(size_t len) noexcept {
+        if constexpr (tail_zeroed)
+            clear_words(const_span::words_for_bitcount_unchecked(std::min(len, _len)), words().count());
+        _stats.on_resize(_len, std::min(len, _len));
+        return _len = std::min(len, _len);
+    }
+    [[nodiscard]] alloc_counters memory_stats() const noexcept { return _stats.snapshot(); }
+    void reset_memory_stats() noexcept { _stats.reset(); }
     // --- end accessors ---
 
     // --- span acquisition ---
@@ -119,26 +189,48 @@ public:
     [[nodiscard]] operator bitspan<W const>() && = delete;
     [[nodiscard]] operator bitspan<W      >() && = delete;
 
-    [[nodiscard]] bitspan<W const> span() const & noexcept
-        { return bitspan<W const>(*this); }
-    [[nodiscard]] bitspan<W      > span()       & noexcept
-        { return bitspan<W      >(*this); }
-    [[nodiscard]] bitspan<W> span() && = delete;
+    [[nodiscard]] const_span span() const & noexcept { return const_span(_base, _len); }
+    [[nodiscard]] mut_span   span()       & noexcept { return mut_span  (_base, _len); }
+    [[nodiscard]] mut_span   span() && = delete;
     // --- end span acquisition ---
 
     // --- misc utilities ---
-    template<bitspan_word O>
-    void ensure_eq_length(bitspan<O> o) const
+    template<bitspan_word O, size_t E, typename D>
+    void ensure_eq_length(bitspan<O, E, D> o) const
         { if (_len != o.len()) throw bitspan_length_mismatch(); }
-    template<bitspan_word O>
-    void ensure_eq_length(bitvec<O> const& o) const { ensure_eq_length(o.span()); }
+    template<bitspan_word O, typename B, typename D>
+    void ensure_eq_length(bitvec<O, B, D> const& o) const { ensure_eq_length(o.span()); }
     // --- end misc utilities ---
 
     /// --- indexing ---
     [[nodiscard]] bool       operator[](size_t i) const { return span()[i]; }
     [[nodiscard]] bit_ref<W> operator[](size_t i)       { return span()[i]; }
+    // Whatever the policy, these never check i
+    [[nodiscard]] bool test_unchecked(size_t i) const noexcept { return span().test_unchecked(i); }
+    bitvec& set_unchecked(size_t i, bool val = true) noexcept
+        { span().set_unchecked(i, val); return *this; }
     /// --- end indexing ---
 
+    /// --- batched indexing ---
+    template<bitspan_index_range R>
+    bitvec& set_many  (R const& idx, scatter_order order = scatter_order::given)
+        { span().set_many(idx, order);   return *this; }
+    template<bitspan_index_range R>
+    bitvec& reset_many(R const& idx, scatter_order order = scatter_order::given)
+        { span().reset_many(idx, order); return *this; }
+    template<bitspan_index_range R>
+    bitvec& flip_many (R const& idx, scatter_order order = scatter_order::given)
+        { span().flip_many(idx, order);  return *this; }
+    template<bitspan_index_range R>
+    void test_many(R const& idx, bitspan<W> out) const { span().test_many(idx, out); }
+    template<bitspan_index_range R>
+    void test_many(R const& idx, std::span<uint8_t> out) const { span().test_many(idx, out); }
+    /// The bits at idx, packed in order.
+    template<bitspan_index_range R>
+    [[nodiscard]] bitvec test_many(R const& idx) const
+        { bitvec rslt(std::ranges::size(idx)); test_many(idx, rslt.span()); return rslt; }
+    /// --- end batched indexing ---
+
     /// --- bulk bitwise operations ---
     [[nodiscard]] bool operator ==(bitspan<W const> o) const noexcept { return span()==o; }
     [[nodiscard]] bool operator ==(bitvec const&    o) const noexcept { return span()==o.span(); }
@@ -147,50 +239,101 @@ public:
     bitvec& operator &=(bitspan<W const> o) { span() &= o;        return *this; }
     bitvec& operator |=(bitspan<W const> o) { span() |= o;        return *this; }
     bitvec& operator ^=(bitspan<W const> o) { span() ^= o;        return *this; }
+    bitvec& and_not    (bitspan<W const> o) { span().and_not(o);  return *this; }
     bitvec& set_from   (bitspan<W const> o) { span().set_from(o); return *this; }
 
     bitvec& operator &=(bitvec    const& o) { return *this &= o.span();  }
     bitvec& operator |=(bitvec    const& o) { return *this |= o.span();  }
     bitvec& operator ^=(bitvec    const& o) { return *this ^= o.span();  }
+    bitvec& and_not    (bitvec    const& o) { return and_not(o.span());  }
     bitvec& set_from   (bitvec    const& o) { return set_from(o.span()); }
 
-    [[nodiscard]] bitvec operator ~() const
-        { auto rslt = *this; rslt.invert(); return rslt; }
-    [[nodiscard]] bitvec operator &(bitspan<W const> o) const
-        { auto rslt = *this; rslt.resize(std::max(rslt.len(), o.len())); rslt &= o; return rslt; }
-    [[nodiscard]] bitvec operator |(bitspan<W const> o) const
-        { auto rslt = *this; rslt.resize(std::max(rslt.len(), o.len())); rslt |= o; return rslt; }
-    [[nodiscard]] bitvec operator ^(bitspan<W const> o) const
-        { auto rslt = *this; rslt.resize(std::max(rslt.len(), o.len())); rslt ^= o; return rslt; }
-    [[nodiscard]] bitvec operator &(bitvec const& o) const { return *this & o.span(); }
-    [[nodiscard]] bitvec operator |(bitvec const& o) const { return *this | o.span(); }
-    [[nodiscard]] bitvec operator ^(bitvec const& o) const { return *this ^ o.span(); }
+    // An expiring left operand lends its buffer to the result, so a chain
+    // like f() & g() | h() allocates nothing beyond its operands.  Two
+    // expiring operands reuse whichever has the larger capacity, which for
+    // these commutative ops may be the right one.
+    [[nodiscard]] bitvec operator ~() const & { auto rslt = *this; return ~std::move(rslt); }
+    [[nodiscard]] bitvec operator ~() &&      { invert(); return std::move(*this); }
+
+    [[nodiscard]] bitvec operator &(bitspan<W const> o) const & { auto rslt = *this; return std::move(rslt) & o; }
+    [[nodiscard]] bitvec operator |(bitspan<W const> o) const & { auto rslt = *this; return std::move(rslt) | o; }
+    [[nodiscard]] bitvec operator ^(bitspan<W const> o) const & { auto rslt = *this; return std::move(rslt) ^ o; }
+    [[nodiscard]] bitvec operator &(bitspan<W const> o) &&
+        { resize(std::max(len(), o.len())); *this &= o; return std::move(*this); }
+    [[nodiscard]] bitvec operator |(bitspan<W const> o) &&
+        { resize(std::max(len(), o.len())); *this |= o; return std::move(*this); }
+    [[nodiscard]] bitvec operator ^(bitspan<W const> o) &&
+        { resize(std::max(len(), o.len())); *this ^= o; return std::move(*this); }
+
+    [[nodiscard]] bitvec operator &(bitvec const& o) const & { return *this & o.span(); }
+    [[nodiscard]] bitvec operator |(bitvec const& o) const & { return *this | o.span(); }
+    [[nodiscard]] bitvec operator ^(bitvec const& o) const & { return *this ^ o.span(); }
+    [[nodiscard]] bitvec operator &(bitvec const& o) && { return std::move(*this) & o.span(); }
+    [[nodiscard]] bitvec operator |(bitvec const& o) && { return std::move(*this) | o.span(); }
+    [[nodiscard]] bitvec operator ^(bitvec const& o) && { return std::move(*this) ^ o.span(); }
+    [[nodiscard]] bitvec operator &(bitvec&& o) const & { return std::move(o) & span(); }
+    [[nodiscard]] bitvec operator |(bitvec&& o) const & { return std::move(o) | span(); }
+    [[nodiscard]] bitvec operator ^(bitvec&& o) const & { return std::move(o) ^ span(); }
+    [[nodiscard]] bitvec operator &(bitvec&& o) &&
+        { return o._cap > _cap ? std::move(o) & span() : std::move(*this) & o.span(); }
+    [[nodiscard]] bitvec operator |(bitvec&& o) &&
+        { return o._cap > _cap ? std::move(o) | span() : std::move(*this) | o.span(); }
+    [[nodiscard]] bitvec operator ^(bitvec&& o) &&
+        { return o._cap > _cap ? std::move(o) ^ span() : std::move(*this) ^ o.span(); }
     /// --- end bulk bitwise operations ---
 
+    /// --- set predicates ---
+    [[nodiscard]] bool any () const noexcept { return span().any();  }
+    [[nodiscard]] bool none() const noexcept { return span().none(); }
+    [[nodiscard]] bool intersects            (bitspan<W const> o) const noexcept
+        { return span().intersects(o); }
+    [[nodiscard]] bool is_disjoint           (bitspan<W const> o) const noexcept
+        { return span().is_disjoint(o); }
+    [[nodiscard]] bool is_subset_of          (bitspan<W const> o) const noexcept
+        { return span().is_subset_of(o); }
+    [[nodiscard]] bool is_superset_of        (bitspan<W const> o) const noexcept
+        { return span().is_superset_of(o); }
+    [[nodiscard]] bool equals_ignoring_length(bitspan<W const> o) const noexcept
+        { return span().equals_ignoring_length(o); }
+    /// --- end set predicates ---
+
+    /// --- counting ---
+    [[nodiscard]] size_t count       (                  ) const noexcept
+        { return span().count(); }
+    [[nodiscard]] size_t count_and   (bitspan<W const> o) const noexcept
+        { return span().count_and(o); }
+    [[nodiscard]] size_t count_andnot(bitspan<W const> o) const noexcept
+        { return span().count_andnot(o); }
+    [[nodiscard]] size_t count_or    (bitspan<W const> o) const noexcept
+        { return span().count_or(o); }
+    [[nodiscard]] size_t count_xor   (bitspan<W const> o) const noexcept
+        { return span().count_xor(o); }
+    /// --- end counting ---
+
     /// --- helper constructors ---
     [[nodiscard]] words_t<false> words() const noexcept { return {*this}; }
     [[nodiscard]] words_t<true > words()       noexcept { return {*this}; }
     [[nodiscard]] indices bit_indices () const noexcept { return indices(_len); }
     [[nodiscard]] indices word_indices() const noexcept { return indices(words().count()); }
     template<bool in> [[nodiscard]] iter_t<in> iter() const noexcept
-        { return span().iter(); }
+        { return span().template iter<in>(); }
 
     /// --- end helper constructors ---
 };
 
-template<bool mut, bitspan_word W> requires (!std::is_const_v<W>)
+template<bool mut, bitspan_word W, typename A, typename C> requires (!std::is_const_v<W>)
 struct bitvec_words final {
 private:
-    friend bitvec<W>;
-    friend bitvec_words<true, W>;
-    std::conditional_t<mut, bitvec<W>&, bitvec<W> const&> vec;
+    friend bitvec<W, A, C>;
+    friend bitvec_words<true, W, A, C>;
+    std::conditional_t<mut, bitvec<W, A, C>&, bitvec<W, A, C> const&> vec;
 
     bitvec_words(decltype(vec) vec) noexcept : vec(vec) {}
 
 public:
     using deref_type = std::conditional_t<mut, W, const W>;
 
-    bitvec_words(bitvec_words<false, W> o) noexcept : vec(o.vec) {}
+    bitvec_words(bitvec_words<false, W, A, C> o) noexcept : vec(o.vec) {}
     [[nodiscard]] deref_type* begin() const noexcept { return vec._base; }
     [[nodiscard]] deref_type* end  () const noexcept { return begin() + count(); }
     [[nodiscard]] W const*   cbegin() const noexcept { return begin(); }
@@ -202,9 +345,32 @@ public:
         { return begin()[bitspan<W>::maj_bi(i)]; }
 };
 
-template<bitspan_word W>
-std::ostream& operator<<(std::ostream& o, bitvec<W> const& b) { return o << b.span(); }
+// A span on the left; the result takes the vector's policies and, when the
+// vector is expiring, its buffer.
+template<bitspan_word W, typename A, typename C>
+[[nodiscard]] bitvec<W, A, C> operator &(std::type_identity_t<bitspan<W const>> a, bitvec<W, A, C> const& b)
+    { return b & a; }
+template<bitspan_word W, typename A, typename C>
+[[nodiscard]] bitvec<W, A, C> operator |(std::type_identity_t<bitspan<W const>> a, bitvec<W, A, C> const& b)
+    { return b | a; }
+template<bitspan_word W, typename A, typename C>
+[[nodiscard]] bitvec<W, A, C> operator ^(std::type_identity_t<bitspan<W const>> a, bitvec<W, A, C> const& b)
+    { return b ^ a; }
+template<bitspan_word W, typename A, typename C>
+[[nodiscard]] bitvec<W, A, C> operator &(std::type_identity_t<bitspan<W const>> a, bitvec<W, A, C>&& b)
+    { return std::move(b) & a; }
+template<bitspan_word W, typename A, typename C>
+[[nodiscard]] bitvec<W, A, C> operator |(std::type_identity_t<bitspan<W const>> a, bitvec<W, A, C>&& b)
+    { return std::move(b) | a; }
+template<bitspan_word W, typename A, typename C>
+[[nodiscard]] bitvec<W, A, C> operator ^(std::type_identity_t<bitspan<W const>> a, bitvec<W, A, C>&& b)
+    { return std::move(b) ^ a; }
+
+template<bitspan_word W, typename A, typename C>
+std::ostream& operator<<(std::ostream& o, bitvec<W, A, C> const& b) { return o << b.span(); }
 
 /// --- explicit instantiation ---
 template struct bitvec<>;
+template struct bitvec<default_bitspan_word, huge_page_alloc<>>;
+template struct bitvec<default_bitspan_word, malloc_alloc, index_unchecked>;
 /// --- end explicit instantiation ---
@@ -0,0 +1,226 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/// Storage policy of a bitvec.  Every function works on byte counts, and
+/// the failing ones return nullptr for the bitvec to turn into bad_alloc.
+/// reallocate preserves the first min(old_bytes, new_bytes) bytes; the
+/// byte count given to reallocate and deallocate is the one the buffer was
+/// last allocated with.  A policy whose buffers cannot exceed some size
+/// says so with a static max_bytes, which caps the bitvec's amortized growth.
+/// A policy sets allocates_zeroed when allocate returns zero-filled memory,
+/// or provides allocate_zeroed for the bitvec to call when it needs zeroed
+/// words rather than ones it is about to overwrite, and sets grows_zeroed
+/// when reallocate zero-fills the bytes past old_bytes; the bitvec then
+/// skips clearing new words, so the untouched pages of a large vector are
+/// never faulted in.  A policy may also provide
+/// discard(p, from, to), which zeroes bytes [from, to) of a live buffer and
+/// which the bitvec then uses, instead of memset, to clear the words it drops.
+template<typename A>
+concept bitvec_alloc = requires(void* p, size_t n) {
+    { A::alignment        } -> std::convertible_to<size_t>;
+    { A::allocate(n)      } -> std::same_as<void*>;
+    { A::reallocate(p, n, n) } -> std::same_as<void*>;
+    { A::deallocate(p, n) } noexcept;
+};
+
+/// malloc/realloc/free, with whatever alignment malloc gives.  Zeroed
+/// buffers come from calloc, which serves large requests with fresh,
+/// already-zero pages.
+struct malloc_alloc final {
+    static constexpr size_t alignment = alignof(std::max_align_t);
+
+    [[nodiscard]] static void* allocate(size_t bytes) noexcept { return malloc(bytes); } // NOLINT
+    [[nodiscard]] static void* allocate_zeroed(size_t bytes) noexcept { return calloc(bytes, 1); } // NOLINT
+    [[nodiscard]] static void* reallocate(void* p, size_t, size_t new_bytes) noexcept
+        { return realloc(p, new_bytes); } // NOLINT
+    static void deallocate(void* p, size_t) noexcept { free(p); } // NOLINT
+};
+
+/// Storage aligned to Align bytes, a cache line by default, so that no
+/// vector-width block of words straddles two lines.  There is no aligned
+/// realloc, so growth allocates, copies and frees.
+template<size_t Align = 64>
+struct line_aligned_alloc final {
+    static_assert(std::has_single_bit(Align) && Align >= alignof(std::max_align_t));
+    static constexpr size_t alignment = Align;
+
+    [[nodiscard]] static void* allocate(size_t bytes) noexcept
+        { return std::aligned_alloc(Align, (bytes + Align - 1) & ~(Align - 1)); }
+    [[nodiscard]] static void* reallocate(void* p, size_t old_bytes, size_t new_bytes) noexcept {
+        void* q = allocate(new_bytes);
+        if (q == nullptr) return nullptr;
+        memcpy(q, p, std::min(old_bytes, new_bytes));
+        free(p); // NOLINT
+        return q;
+    }
+    static void deallocate(void* p, size_t) noexcept { free(p); } // NOLINT
+};
+
+/// Buffers of at least Threshold bytes are anonymous mappings aligned to
+/// and padded out to 2 MiB huge pages, so a multi-GB vector costs one TLB
+/// entry per 2 MiB instead of per 4 KiB.  With Hugetlb the mapping first
+/// asks for pages from the hugetlbfs pool; either way it is advised
+/// MADV_HUGEPAGE for transparent huge pages, which the kernel honours when
+/// it can and ignores otherwise.  Growth moves the pages with mremap rather
+/// than copying them.  Smaller buffers, and every buffer on systems without
+/// these calls, come from line_aligned_alloc.  Mappings come zero-filled;
+/// small buffers are cleared explicitly when zeroed ones are asked for, and
+/// when they grow, so that both cases look alike.
+template<bool Hugetlb = false, size_t Threshold = size_t(2) << 20>
+struct huge_page_alloc final {
+    using small_alloc = line_aligned_alloc<>;
+    static constexpr size_t alignment = small_alloc::alignment;
+    static constexpr size_t huge_page = size_t(2) << 20;
+    static constexpr bool grows_zeroed = true;
+
+private:
+    [[nodiscard]] static void* small_allocate(size_t bytes) noexcept {
+        void* p = small_alloc::allocate(bytes);
+        if (p != nullptr) memset(p, 0, bytes);
+        return p;
+    }
+    [[nodiscard]] static void* small_reallocate(void* p, size_t old_bytes, size_t new_bytes) noexcept {
+        void* q = small_alloc::reallocate(p, old_bytes, new_bytes);
+        if (q != nullptr && new_bytes > old_bytes)
+            memset(static_cast<char*>(q) + old_bytes, 0, new_bytes - old_bytes);
+        return q;
+    }
+
+#if defined(__linux__)
+    [[nodiscard]] static bool is_mapped(size_t bytes) noexcept { return bytes >= Threshold; }
+    [[nodiscard]] static size_t mapping_len(size_t bytes) noexcept
+        { return (bytes + huge_page - 1) & ~(huge_page - 1); }
+
+    [[nodiscard]] static void* map(size_t bytes) noexcept {
+        size_t len = mapping_len(bytes);
+        if constexpr (Hugetlb) {
+            void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) return p;
+        }
+        // Over-map by a huge page and trim both ends to a 2 MiB boundary
+        void* raw = mmap(nullptr, len + huge_page, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) return nullptr;
+        auto* lo  = static_cast<char*>(raw);
+        auto* p   = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(lo) + huge_page - 1) & ~(huge_page - 1));
+        if (p != lo) munmap(lo, p - lo);
+        if (size_t tail = (lo + len + huge_page) - (p + len); tail != 0) munmap(p + len, tail);
+        madvise(p, len, MADV_HUGEPAGE);
+        return p;
+    }
+
+public:
+    [[nodiscard]] static void* allocate(size_t bytes) noexcept
+        { return is_mapped(bytes) ? map(bytes) : small_alloc::allocate(bytes); }
+    [[nodiscard]] static void* allocate_zeroed(size_t bytes) noexcept
+        { return is_mapped(bytes) ? map(bytes) : small_allocate(bytes); }
+    [[nodiscard]] static void* reallocate(void* p, size_t old_bytes, size_t new_bytes) noexcept {
+        if (!is_mapped(old_bytes) && !is_mapped(new_bytes))
+            return small_reallocate(p, old_bytes, new_bytes);
+        if (is_mapped(old_bytes) && is_mapped(new_bytes)) {
+            size_t old_len = mapping_len(old_bytes), new_len = mapping_len(new_bytes);
+            // What a shrink keeps of the old contents must read as zero if regrown
+            if (new_bytes < old_bytes)
+                memset(static_cast<char*>(p) + new_bytes, 0, std::min(old_bytes, new_len) - new_bytes);
+            if (old_len == new_len) return p;
+            if (mremap(p, old_len, new_len, 0) != MAP_FAILED) return p;
+            void* q = map(new_bytes);
+            if (q == nullptr) return nullptr;
+            // Moving the pages over the new, aligned range replaces it
+            if (mremap(p, old_len, new_len, MREMAP_MAYMOVE | MREMAP_FIXED, q) != MAP_FAILED) return q;
+            memcpy(q, p, std::min(old_bytes, new_bytes));
+            munmap(p, old_len);
+            return q;
+        }
+        void* q = allocate(new_bytes);
+        if (q == nullptr) return nullptr;
+        memcpy(q, p, std::min(old_bytes, new_bytes));
+        deallocate(p, old_bytes);
+        return q;
+    }
+    static void deallocate(void* p, size_t bytes) noexcept {
+        if (is_mapped(bytes)) munmap(p, mapping_len(bytes));
+        else                  small_alloc::deallocate(p, bytes);
+    }
+#else
+public:
+    [[nodiscard]] static void* allocate(size_t bytes) noexcept { return small_alloc::allocate(bytes); }
+    [[nodiscard]] static void* allocate_zeroed(size_t bytes) noexcept { return small_allocate(bytes); }
+    [[nodiscard]] static void* reallocate(void* p, size_t old_bytes, size_t new_bytes) noexcept
+        { return small_reallocate(p, old_bytes, new_bytes); }
+    static void deallocate(void* p, size_t bytes) noexcept { small_alloc::deallocate(p, bytes); }
+#endif
+};
+
+#if defined(__linux__)
+/// Reserves ReserveBytes of address space per buffer with an inaccessible
+/// mapping and makes pages readable and writable as the buffer grows, so
+/// growth never moves or copies the words and spans taken before a resize
+/// stay valid.  The reservation costs no memory, but it costs address space
+/// for every live buffer, copies and temporaries included: at the 64 GiB
+/// default a 47-bit address space holds about two thousand of them.  Pick
+/// ReserveBytes near the largest size the vector will reach.  Buffers
+/// cannot grow past it.  Newly committed pages read as zero until written,
+/// and words the vector drops are discarded, which hands their whole pages
+/// back to the system.
+template<size_t ReserveBytes = size_t(1) << 36>
+struct reserved_alloc final {
+    static constexpr size_t alignment = 4096;
+    static constexpr size_t max_bytes = ReserveBytes;
+    static constexpr bool allocates_zeroed = true;
+    static constexpr bool grows_zeroed     = true;
+
+private:
+    [[nodiscard]] static size_t page_size() noexcept {
+        static const size_t page = size_t(sysconf(_SC_PAGESIZE));
+        return page;
+    }
+    [[nodiscard]] static size_t committed(size_t bytes) noexcept
+        { return (bytes + page_size() - 1) & ~(page_size() - 1); }
+
+public:
+    [[nodiscard]] static void* allocate(size_t bytes) noexcept {
+        if (bytes > max_bytes) return nullptr;
+        void* p = mmap(nullptr, max_bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED) return nullptr;
+        if (mprotect(p, committed(bytes), PROT_READ | PROT_WRITE) != 0) { munmap(p, max_bytes); return nullptr; }
+        return p;
+    }
+    [[nodiscard]] static void* reallocate(void* p, size_t old_bytes, size_t new_bytes) noexcept {
+        if (new_bytes > max_bytes) return nullptr;
+        size_t old_len = committed(old_bytes), new_len = committed(new_bytes);
+        auto* base = static_cast<char*>(p);
+        if (new_len > old_len) {
+            if (mprotect(base + old_len, new_len - old_len, PROT_READ | PROT_WRITE) != 0) return nullptr;
+        } else if (new_bytes < old_bytes) {
+            discard(p, new_bytes, old_bytes);
+            if (new_len < old_len) mprotect(base + new_len, old_len - new_len, PROT_NONE);
+        }
+        return p;
+    }
+    /// Zeroes bytes [from, to) of the buffer.  The whole pages among them
+    /// are returned to the system rather than written, and read as zero
+    /// when next touched.
+    static void discard(void* p, size_t from, size_t to) noexcept {
+        if (from >= to) return;
+        auto* base = static_cast<char*>(p);
+        size_t lo = committed(from), hi = to & ~(page_size() - 1);
+        if (lo >= hi) { memset(base + from, 0, to - from); return; }
+        memset(base + from, 0, lo - from);
+        madvise(base + lo, hi - lo, MADV_DONTNEED);
+        memset(base + hi, 0, to - hi);
+    }
+    static void deallocate(void* p, size_t) noexcept { munmap(p, max_bytes); }
+};
+#endif
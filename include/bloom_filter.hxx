@@ -0,0 +1,335 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include "bitspan.hxx"
+#include "bitvec.hxx"
+#include "forward.hxx"
+
+struct bloom_format_error final : std::runtime_error
+    { bloom_format_error() : std::runtime_error("malformed serialized bloom filter"){}};
+
+/// Finalizer of splitmix64.  The filters expect well-mixed 64-bit hashes;
+/// this turns integer keys or weak hashes into such.
+[[nodiscard]] constexpr uint64_t bloom_mix(uint64_t x) noexcept {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+// --- shared helpers ---
+namespace bloom_detail {
+    /// Maps x uniformly onto [0, n) without a division (Lemire's fastrange).
+    [[nodiscard]] constexpr size_t reduce(uint64_t x, size_t n) noexcept
+        { return static_cast<size_t>((static_cast<unsigned __int128>(x) * n) >> 64); }
+
+    /// Bits for n keys at false-positive rate fpp, m = -n ln(fpp) / ln(2)^2,
+    /// scaled by pad.  Throws invalid_argument unless 0 < fpp < 1 and the
+    /// result fits a size_t.
+    [[nodiscard]] inline size_t bits_for(size_t n, double fpp, double pad = 1) {
+        if (!(fpp > 0 && fpp < 1)) throw std::invalid_argument("bloom filter rate must be in (0, 1)");
+        double ln2 = std::log(2.0);
+        double m = std::ceil(-double(std::max<size_t>(n, 1)) * std::log(fpp) / (ln2 * ln2) * pad);
+        if (!(m < double(SIZE_MAX))) throw std::invalid_argument("bloom filter too large for size_t");
+        return static_cast<size_t>(m);
+    }
+
+    /// Batches are processed this many keys behind the prefetches.
+    inline constexpr size_t prefetch_distance = 16;
+    inline void prefetch_read (void const* p) noexcept { __builtin_prefetch(p, 0); }
+    inline void prefetch_write(void const* p) noexcept { __builtin_prefetch(p, 1); }
+
+    // Serialized layout, in host byte order: magic, format, word bytes,
+    // probe count, bit length, then the words of the bit array.  Only
+    // little-endian hosts are supported, so the format is little-endian.
+    static_assert(std::endian::native == std::endian::little);
+    inline constexpr uint32_t magic = 0x4d4f4c42; // "BLOM"
+    /// The words are read this many bytes at a time, growing the vector as
+    /// they arrive, so a header claiming more bits than the stream holds
+    /// fails on the short read instead of allocating the claimed length.
+    inline constexpr size_t read_piece_bytes = size_t(1) << 20;
+    template<bitspan_word W, typename A>
+    void write(std::ostream& o, uint32_t format, uint32_t k, bitvec<W, A> const& bits) {
+        uint32_t header[4] = {magic, format, uint32_t(sizeof(W)), k};
+        uint64_t len = bits.len();
+        o.write(reinterpret_cast<char const*>(header), sizeof(header));
+        o.write(reinterpret_cast<char const*>(&len), sizeof(len));
+        o.write(reinterpret_cast<char const*>(bits.words().begin()),
+                static_cast<std::streamsize>(bits.words().count() * sizeof(W)));
+    }
+    template<bitspan_word W, typename A>
+    bitvec<W, A> read(std::istream& in, uint32_t format, uint32_t& k) {
+        constexpr size_t bits_per_word = bitspan<W>::bits_per_word;
+        uint32_t header[4];
+        uint64_t len;
+        in.read(reinterpret_cast<char*>(header), sizeof(header));
+        in.read(reinterpret_cast<char*>(&len), sizeof(len));
+        if (!in || header[0] != magic || header[1] != format || header[2] != sizeof(W))
+            throw bloom_format_error();
+        bitvec<W, A> bits;
+        size_t words = len / bits_per_word + (len % bits_per_word != 0);
+        for (size_t done = 0; done < words;) {
+            size_t n = std::min(read_piece_bytes / sizeof(W), words - done);
+            bits.resize(done + n == words ? len : (done + n) * bits_per_word);
+            in.read(reinterpret_cast<char*>(bits.words().begin() + done),
+                    static_cast<std::streamsize>(n * sizeof(W)));
+            if (!in) throw bloom_format_error();
+            done += n;
+        }
+        bits.span().clear_residual();
+        k = header[3];
+        return bits;
+    }
+}
+// --- end shared helpers ---
+
+/// Standard Bloom filter over a bitvec: k probes per key at positions
+/// h1 + i * h2 (Kirsch and Mitzenmacher), each a separate cache line.
+template<bitspan_word W> requires (!std::is_const_v<W>)
+struct bloom_filter final {
+public:
+    // --- type associations ---
+    using word       = W;
+    using const_span = bitspan<W const>;
+    // --- end type associations ---
+
+    static constexpr uint32_t format = 1;
+
+private:
+    // --- fields ---
+    bitvec<W> _bits;
+    unsigned  _k = 0;
+    // --- end fields ---
+
+    template<typename F>
+    void for_each_probe(uint64_t hash, F f) const {
+        uint64_t h1 = hash, h2 = (hash >> 32) | (hash << 32) | 1;
+        for (unsigned i = 0; i < _k; i++, h1 += h2) f(bloom_detail::reduce(h1, _bits.len()));
+    }
+    void prefetch(uint64_t hash, bool write) const {
+        for_each_probe(hash, [&](size_t p) {
+            auto* addr = &_bits.words().of_bit(p);
+            write ? bloom_detail::prefetch_write(addr) : bloom_detail::prefetch_read(addr);
+        });
+    }
+
+    // Only as the empty object deserialize fills; a filter without bits or
+    // probes would answer every query wrongly.
+    bloom_filter() noexcept = default;
+
+public:
+    // --- constructors ---
+    bloom_filter(size_t bits, unsigned k) : _bits(bits), _k(k) {
+        if (bits == 0 || k == 0) throw std::invalid_argument("bloom_filter needs bits and probes");
+    }
+    /// Sized for n keys at false-positive rate fpp: m = -n ln(fpp) / ln(2)^2
+    /// bits and k = m / n ln(2) probes.
+    [[nodiscard]] static bloom_filter for_capacity(size_t n, double fpp) {
+        size_t m = bloom_detail::bits_for(n, fpp);
+        double k = std::round(double(m) / double(std::max<size_t>(n, 1)) * std::log(2.0));
+        return bloom_filter(m, static_cast<unsigned>(std::max(1.0, k)));
+    }
+    // --- end constructors ---
+
+    // --- accessors ---
+    [[nodiscard]] size_t     len()  const noexcept { return _bits.len(); }
+    [[nodiscard]] unsigned   k()    const noexcept { return _k; }
+    [[nodiscard]] const_span bits() const noexcept { return _bits.span(); }
+    // --- end accessors ---
+
+    /// --- single-key operations ---
+    void insert(uint64_t hash) {
+        for_each_probe(hash, [&](size_t p) { _bits.words().of_bit(p) |= W(1) << (p & const_span::minmask); });
+    }
+    [[nodiscard]] bool contains(uint64_t hash) const noexcept {
+        bool all = true;
+        for_each_probe(hash, [&](size_t p) { all &= (_bits.words().of_bit(p) >> (p & const_span::minmask)) & 1; });
+        return all;
+    }
+    /// --- end single-key operations ---
+
+    /// --- batch operations ---
+    // Each key's probe lines are prefetched prefetch_distance keys ahead, so
+    // the misses of consecutive keys overlap instead of serializing.
+    void insert_many(std::span<uint64_t const> hashes) {
+        for (size_t i = 0; i < hashes.size(); i++) {
+            if (i + bloom_detail::prefetch_distance < hashes.size())
+                prefetch(hashes[i + bloom_detail::prefetch_distance], true);
+            insert(hashes[i]);
+        }
+    }
+    /// out[i] = contains(hashes[i]); out must be at least as long as hashes.
+    void contains_many(std::span<uint64_t const> hashes, std::span<bool> out) const {
+        if (out.size() < hashes.size()) throw std::length_error("bloom_filter output too short");
+        for (size_t i = 0; i < hashes.size(); i++) {
+            if (i + bloom_detail::prefetch_distance < hashes.size())
+                prefetch(hashes[i + bloom_detail::prefetch_distance], false);
+            out[i] = contains(hashes[i]);
+        }
+    }
+    /// --- end batch operations ---
+
+    /// --- serialization ---
+    void serialize(std::ostream& o) const { bloom_detail::write(o, format, _k, _bits); }
+    [[nodiscard]] static bloom_filter deserialize(std::istream& in) {
+        bloom_filter f;
+        uint32_t k;
+        f._bits = bloom_detail::read<W, malloc_alloc>(in, format, k);
+        if (k == 0 || f._bits.len() == 0) throw bloom_format_error();
+        f._k = k;
+        return f;
+    }
+    /// --- end serialization ---
+};
+
+/// Split-block Bloom filter: every key maps to one 512-bit block, a single
+/// cache line of the line-aligned storage, and sets one bit in each of its
+/// eight 64-bit lanes, the lane bit being picked by a multiplicative hash of
+/// the key's low half with a per-lane odd constant.  A lookup is a single
+/// line read; with AVX2 the eight probes are computed and tested as two
+/// 256-bit vectors.  Lane bits are addressed in the bitvec's little-endian
+/// bit order, so any word type sees the same layout.
+template<bitspan_word W> requires (!std::is_const_v<W>)
+struct split_block_bloom_filter final {
+public:
+    // --- type associations ---
+    using word       = W;
+    using const_span = bitspan<W const>;
+    // --- end type associations ---
+
+    // --- constants ---
+    static constexpr uint32_t format      = 2;
+    static constexpr size_t   block_bits  = 512;
+    static constexpr size_t   block_bytes = block_bits / 8;
+    static constexpr size_t   lanes       = 8;
+    static constexpr uint32_t salts[lanes] = {0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d,
+                                              0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31};
+    // --- end constants ---
+
+private:
+    // --- fields ---
+    bitvec<W, line_aligned_alloc<block_bytes>> _bits;
+    // --- end fields ---
+
+    [[nodiscard]] size_t block_count() const noexcept { return _bits.len() / block_bits; }
+    [[nodiscard]] size_t block_of(uint64_t hash) const noexcept
+        { return bloom_detail::reduce(hash >> 32 | hash << 32, block_count()); }
+    [[nodiscard]] unsigned char const* block_ptr(size_t b) const noexcept
+        { return reinterpret_cast<unsigned char const*>(_bits.words().begin()) + b * block_bytes; }
+    [[nodiscard]] unsigned char* block_ptr(size_t b) noexcept
+        { return reinterpret_cast<unsigned char*>(_bits.words().begin()) + b * block_bytes; }
+    [[nodiscard]] static size_t lane_bit(uint64_t hash, size_t lane) noexcept
+        { return (uint32_t(hash) * salts[lane]) >> 26; }
+
+#if defined(__AVX2__)
+    /// The two 256-bit halves of the probe mask of a key.
+    static void probe_masks(uint64_t hash, __m256i& lo, __m256i& hi) noexcept {
+        const __m256i salt = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(salts));
+        __m256i idx = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(int(uint32_t(hash))), salt), 26);
+        const __m256i one = _mm256_set1_epi64x(1);
+        lo = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(idx)));
+        hi = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(idx, 1)));
+    }
+#endif
+
+    // Only as the empty object deserialize fills; without blocks every key
+    // would map to a block that does not exist.
+    split_block_bloom_filter() noexcept = default;
+
+public:
+    // --- constructors ---
+    /// At least bits bits, rounded up to whole blocks.
+    explicit split_block_bloom_filter(size_t bits)
+        : _bits(std::max<size_t>(1, bits / block_bits + (bits % block_bits != 0)) * block_bits) {}
+    /// Sized like a standard filter for n keys at rate fpp.  Confining the
+    /// probes to one block costs some accuracy, so the size is padded by a
+    /// quarter.
+    [[nodiscard]] static split_block_bloom_filter for_capacity(size_t n, double fpp)
+        { return split_block_bloom_filter(bloom_detail::bits_for(n, fpp, 1.25)); }
+    // --- end constructors ---
+
+    // --- accessors ---
+    [[nodiscard]] size_t     len()  const noexcept { return _bits.len(); }
+    [[nodiscard]] const_span bits() const noexcept { return _bits.span(); }
+    // --- end accessors ---
+
+    /// --- single-key operations ---
+    void insert(uint64_t hash) noexcept {
+        unsigned char* p = block_ptr(block_of(hash));
+#if defined(__AVX2__)
+        __m256i lo, hi;
+        probe_masks(hash, lo, hi);
+        auto* v = reinterpret_cast<__m256i*>(p);
+        _mm256_storeu_si256(v,     _mm256_or_si256(_mm256_loadu_si256(v),     lo));
+        _mm256_storeu_si256(v + 1, _mm256_or_si256(_mm256_loadu_si256(v + 1), hi));
+#else
+        for (size_t l = 0; l < lanes; l++) {
+            size_t bit = l * 64 + lane_bit(hash, l);
+            p[bit >> 3] |= static_cast<unsigned char>(1u << (bit & 7));
+        }
+#endif
+    }
+    [[nodiscard]] bool contains(uint64_t hash) const noexcept {
+        unsigned char const* p = block_ptr(block_of(hash));
+#if defined(__AVX2__)
+        __m256i lo, hi;
+        probe_masks(hash, lo, hi);
+        auto const* v = reinterpret_cast<__m256i const*>(p);
+        return _mm256_testc_si256(_mm256_loadu_si256(v), lo)
+             & _mm256_testc_si256(_mm256_loadu_si256(v + 1), hi);
+#else
+        bool all = true;
+        for (size_t l = 0; l < lanes; l++) {
+            size_t bit = l * 64 + lane_bit(hash, l);
+            all &= (p[bit >> 3] >> (bit & 7)) & 1;
+        }
+        return all;
+#endif
+    }
+    /// --- end single-key operations ---
+
+    /// --- batch operations ---
+    // One line per key, prefetched prefetch_distance keys ahead.
+    void insert_many(std::span<uint64_t const> hashes) noexcept {
+        for (size_t i = 0; i < hashes.size(); i++) {
+            if (i + bloom_detail::prefetch_distance < hashes.size())
+                bloom_detail::prefetch_write(block_ptr(block_of(hashes[i + bloom_detail::prefetch_distance])));
+            insert(hashes[i]);
+        }
+    }
+    /// out[i] = contains(hashes[i]); out must be at least as long as hashes.
+    void contains_many(std::span<uint64_t const> hashes, std::span<bool> out) const {
+        if (out.size() < hashes.size()) throw std::length_error("bloom_filter output too short");
+        for (size_t i = 0; i < hashes.size(); i++) {
+            if (i + bloom_detail::prefetch_distance < hashes.size())
+                bloom_detail::prefetch_read(block_ptr(block_of(hashes[i + bloom_detail::prefetch_distance])));
+            out[i] = contains(hashes[i]);
+        }
+    }
+    /// --- end batch operations ---
+
+    /// --- serialization ---
+    void serialize(std::ostream& o) const { bloom_detail::write(o, format, lanes, _bits); }
+    [[nodiscard]] static split_block_bloom_filter deserialize(std::istream& in) {
+        split_block_bloom_filter f;
+        uint32_t k;
+        f._bits = bloom_detail::read<W, line_aligned_alloc<block_bytes>>(in, format, k);
+        if (k != lanes || f._bits.len() == 0 || f._bits.len() % block_bits != 0)
+            throw bloom_format_error();
+        return f;
+    }
+    /// --- end serialization ---
+};
+
+/// --- explicit instantiation ---
+template struct bloom_filter<>;
+template struct split_block_bloom_filter<>;
+/// --- end explicit instantiation ---
@@ -0,0 +1,257 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+#include "bitspan.hxx"
+#include "bitvec.hxx"
+#include "forward.hxx"
+
+/// Copy-on-write bit vector.  Bits are stored in fixed-size chunks behind a
+/// shared chunk table, so copying is O(1) and a copy shares every chunk with
+/// its source.  The first mutation of a shared table copies the table (one
+/// pointer per chunk), and the first mutation of a shared chunk copies that
+/// chunk alone, so a single bit write costs at most one chunk copy.
+///
+/// mutable_chunk_span points into a chunk owned by this vector at the time
+/// it was taken; like an iterator, it must not be used after the vector is
+/// copied.  Bit references from operator[] hold the vector and the index
+/// instead, and stay valid across copies.
+template<bitspan_word W> requires (!std::is_const_v<W>)
+struct cow_bitvec final {
+public:
+    // --- type associations ---
+    using word       = W;
+    using const_span = bitspan<W const>;
+    using mut_span   = bitspan<W>;
+    // --- end type associations ---
+
+    // --- constants ---
+    static constexpr size_t bits_per_word = const_span::bits_per_word;
+    static constexpr size_t chunk_bytes   = 4096;
+    static constexpr size_t chunk_words   = chunk_bytes / sizeof(W);
+    static constexpr size_t chunk_bits    = chunk_words * bits_per_word;
+    // --- end constants ---
+
+private:
+    // --- fields ---
+    struct chunk final { std::array<W, chunk_words> words {}; };
+    using chunk_ptr = std::shared_ptr<chunk>;
+    using table     = std::vector<chunk_ptr>;
+
+    std::shared_ptr<table> _chunks;
+    size_t                 _len = 0;
+    // --- end fields ---
+
+    // --- ownership helpers ---
+    table& own_table() {
+        if (_chunks.use_count() != 1) _chunks = std::make_shared<table>(*_chunks);
+        return *_chunks;
+    }
+    chunk& own_chunk(size_t c) {
+        auto& t = own_table();
+        if (t[c].use_count() != 1) t[c] = std::make_shared<chunk>(*t[c]);
+        return *t[c];
+    }
+    [[nodiscard]] bool same_chunk(cow_bitvec const& o, size_t c) const noexcept
+        { return (*_chunks)[c] == (*o._chunks)[c] && chunk_len(c) == o.chunk_len(c); }
+    void ensure_idx(size_t i) const
+        { if (i >= _len) throw std::out_of_range("cow_bitvec index out of range"); }
+
+    // Points chunk c at a zeroed chunk shared by every chunk cleared through
+    // the same zero, instead of copying the old contents only to clear them.
+    void clear_chunk(size_t c, chunk_ptr& zero) {
+        if (!zero) zero = std::make_shared<chunk>();
+        own_table()[c] = zero;
+    }
+
+    // Applies op chunk by chunk.  Chunks past the end of o are cleared when
+    // zero_extend is set; chunks shared with o are cleared when self_clears
+    // is set (x ^ x, x & ~x) and otherwise left alone (x & x, x | x).
+    template<bool zero_extend, bool self_clears, typename Op>
+    cow_bitvec& apply(cow_bitvec const& o, Op op) {
+        if (_len < o._len) throw bitspan_length_mismatch();
+        chunk_ptr zero;
+        for (size_t c = 0; c < chunk_count(); c++) {
+            if (c >= o.chunk_count()) {
+                if constexpr (zero_extend) clear_chunk(c, zero);
+            } else if (same_chunk(o, c)) {
+                if constexpr (self_clears) clear_chunk(c, zero);
+            } else {
+                op(mutable_chunk_span(c), o.chunk_span(c));
+            }
+        }
+        return *this;
+    }
+    template<bool zero_extend, typename Op>
+    cow_bitvec& apply(const_span o, Op op) {
+        if (_len < o.len()) throw bitspan_length_mismatch();
+        chunk_ptr zero;
+        for (size_t c = 0; c < chunk_count(); c++) {
+            size_t start = c * chunk_bits;
+            if (start >= o.len()) {
+                if constexpr (zero_extend) clear_chunk(c, zero);
+                continue;
+            }
+            op(mutable_chunk_span(c), const_span(o.words().begin() + c * chunk_words,
+                                                 std::min(chunk_bits, o.len() - start)));
+        }
+        return *this;
+    }
+    // --- end ownership helpers ---
+
+public:
+    /// Proxy for one bit.  Reading goes through the shared chunk; only
+    /// writing a different value detaches the chunk, so reading through a
+    /// non-const vector keeps its snapshots shared.
+    struct reference final {
+    private:
+        friend struct cow_bitvec;
+        cow_bitvec* vec;
+        size_t      idx;
+
+        reference(cow_bitvec* v, size_t i) noexcept : vec(v), idx(i) {}
+
+    public:
+        reference() = delete;
+        [[nodiscard]] operator bool() const noexcept
+            { return vec->chunk_span(idx / chunk_bits).test_unchecked(idx % chunk_bits); }
+        reference operator =(bool val) const { // NOLINT, proxy reference
+            if (bool(*this) != val) flip();
+            return *this;
+        }
+        reference operator|=(bool val) const { return *this = bool(*this) || val; }
+        reference operator&=(bool val) const { return *this = bool(*this) && val; }
+        reference operator^=(bool val) const { return *this = bool(*this) != val; }
+        reference flip() const {
+            vec->mutable_chunk_span(idx / chunk_bits).words()[idx % chunk_bits / bits_per_word]
+                ^= W(1) << (idx % bits_per_word);
+            return *this;
+        }
+    };
+
+    // --- constructors ---
+    cow_bitvec() noexcept = default;
+    /// All chunks of a new vector share one zeroed chunk until written.
+    explicit cow_bitvec(size_t len) : _len(len) {
+        size_t count = (len + chunk_bits - 1) / chunk_bits;
+        _chunks = std::make_shared<table>(count, count ? std::make_shared<chunk>() : nullptr);
+    }
+    explicit cow_bitvec(const_span o) : cow_bitvec(o.len()) { set_from(o); }
+    // --- end constructors ---
+
+    // --- accessors ---
+    [[nodiscard]] size_t len() const noexcept { return _len; }
+    [[nodiscard]] size_t chunk_count() const noexcept { return _chunks ? _chunks->size() : 0; }
+    [[nodiscard]] size_t chunk_len(size_t c) const noexcept
+        { return std::min(chunk_bits, _len - c * chunk_bits); }
+    /// Whether chunk c is currently shared with another vector (or with
+    /// other chunks of this one).
+    [[nodiscard]] bool is_chunk_shared(size_t c) const noexcept
+        { return _chunks.use_count() > 1 || (*_chunks)[c].use_count() > 1; }
+    [[nodiscard]] const_span chunk_span(size_t c) const noexcept
+        { return const_span((*_chunks)[c]->words.data(), chunk_len(c)); }
+    /// Detaches chunk c from any other vector before handing out the view.
+    [[nodiscard]] mut_span mutable_chunk_span(size_t c)
+        { return mut_span(own_chunk(c).words.data(), chunk_len(c)); }
+    // --- end accessors ---
+
+    /// --- indexing ---
+    [[nodiscard]] bool operator[](size_t i) const
+        { ensure_idx(i); return chunk_span(i / chunk_bits)[i % chunk_bits]; }
+    [[nodiscard]] reference operator[](size_t i)
+        { ensure_idx(i); return {this, i}; }
+    /// --- end indexing ---
+
+    /// --- bulk bitwise operations ---
+    [[nodiscard]] bool operator ==(cow_bitvec const& o) const noexcept {
+        if (_len != o._len) return false;
+        for (size_t c = 0; c < chunk_count(); c++)
+            if (!same_chunk(o, c) && !(chunk_span(c) == o.chunk_span(c))) return false;
+        return true;
+    }
+    [[nodiscard]] bool operator ==(const_span o) const noexcept {
+        if (_len != o.len()) return false;
+        for (size_t c = 0; c < chunk_count(); c++)
+            if (!(chunk_span(c) == const_span(o.words().begin() + c * chunk_words, chunk_len(c))))
+                return false;
+        return true;
+    }
+
+    cow_bitvec& reset(bool val = false) {
+        // Every chunk is rewritten anyway, so start from one fresh shared chunk
+        if (chunk_count() == 0) return *this;
+        auto fill = std::make_shared<chunk>();
+        if (val) fill->words.fill(W(~W(0)));
+        _chunks = std::make_shared<table>(chunk_count(), fill);
+        return *this;
+    }
+    cow_bitvec& invert() {
+        for (size_t c = 0; c < chunk_count(); c++) mutable_chunk_span(c).invert();
+        return *this;
+    }
+
+    cow_bitvec& operator &=(cow_bitvec const& o)
+        { return apply<true,  false>(o, [](mut_span d, const_span s) { d &= s; }); }
+    cow_bitvec& operator |=(cow_bitvec const& o)
+        { return apply<false, false>(o, [](mut_span d, const_span s) { d |= s; }); }
+    cow_bitvec& operator ^=(cow_bitvec const& o)
+        { return apply<false, true >(o, [](mut_span d, const_span s) { d ^= s; }); }
+    cow_bitvec& and_not    (cow_bitvec const& o)
+        { return apply<false, true >(o, [](mut_span d, const_span s) { d.and_not(s); }); }
+
+    cow_bitvec& operator &=(const_span o)
+        { return apply<true >(o, [](mut_span d, const_span s) { d &= s; }); }
+    cow_bitvec& operator |=(const_span o)
+        { return apply<false>(o, [](mut_span d, const_span s) { d |= s; }); }
+    cow_bitvec& operator ^=(const_span o)
+        { return apply<false>(o, [](mut_span d, const_span s) { d ^= s; }); }
+    cow_bitvec& and_not    (const_span o)
+        { return apply<false>(o, [](mut_span d, const_span s) { d.and_not(s); }); }
+    cow_bitvec& set_from   (const_span o)
+        { return apply<true >(o, [](mut_span d, const_span s) { d.set_from(s); }); }
+
+    [[nodiscard]] cow_bitvec operator ~() const
+        { auto rslt = *this; rslt.invert(); return rslt; }
+    [[nodiscard]] cow_bitvec operator &(cow_bitvec const& o) const
+        { auto rslt = *this; rslt &= o; return rslt; }
+    [[nodiscard]] cow_bitvec operator |(cow_bitvec const& o) const
+        { auto rslt = *this; rslt |= o; return rslt; }
+    [[nodiscard]] cow_bitvec operator ^(cow_bitvec const& o) const
+        { auto rslt = *this; rslt ^= o; return rslt; }
+    /// --- end bulk bitwise operations ---
+
+    /// --- set predicates and counting ---
+    [[nodiscard]] size_t count() const noexcept {
+        size_t total = 0;
+        for (size_t c = 0; c < chunk_count(); c++) total += chunk_span(c).count();
+        return total;
+    }
+    [[nodiscard]] bool any() const noexcept {
+        for (size_t c = 0; c < chunk_count(); c++) if (chunk_span(c).any()) return true;
+        return false;
+    }
+    [[nodiscard]] bool none() const noexcept { return !any(); }
+    /// --- end set predicates and counting ---
+
+    /// --- conversions ---
+    [[nodiscard]] bitvec<W> to_bitvec() const {
+        bitvec<W> rslt(_len);
+        for (size_t c = 0; c < chunk_count(); c++)
+            mut_span(rslt.words().begin() + c * chunk_words, chunk_len(c)).set_from(chunk_span(c));
+        return rslt;
+    }
+    /// --- end conversions ---
+};
+
+template<bitspan_word W>
+std::ostream& operator<<(std::ostream& o, cow_bitvec<W> const& b) {
+    for (size_t c = 0; c < b.chunk_count() && o; c++) o << b.chunk_span(c);
+    return o;
+}
+
+/// --- explicit instantiation ---
+template struct cow_bitvec<>;
+/// --- end explicit instantiation ---
@@ -0,0 +1,109 @@
+#pragma once
+#include <ostream>
+#include <stdexcept>
+#include "bitvec.hxx"
+#include "forward.hxx"
+
+/// Set of elements drawn from the universe [0, universe()), stored as a bitvec
+/// with bit i set iff i is a member.  Every binary operation requires both
+/// operands to share the same universe.
+template<bitspan_word W> requires (!std::is_const_v<W>)
+struct finite_set final {
+public:
+    // --- type associations ---
+    using word       = W;
+    using vec_t      = bitvec<W>;
+    using const_span = bitspan<W const>;
+    // --- end type associations ---
+
+private:
+    // --- fields ---
+    bitvec<W> _bits;
+    // --- end fields ---
+
+    void ensure_member_idx(size_t i) const
+        { if (i >= universe()) throw std::out_of_range("finite_set element out of universe"); }
+
+public:
+    // --- constructors ---
+    finite_set() noexcept = default;
+    explicit finite_set(size_t universe) : _bits(universe) {}
+    explicit finite_set(bitvec<W> bits) noexcept : _bits(std::move(bits)) {}
+    // --- end constructors ---
+
+    // --- accessors ---
+    [[nodiscard]] size_t           universe() const noexcept { return _bits.len(); }
+    [[nodiscard]] bitvec<W> const& bits    () const noexcept { return _bits; }
+    [[nodiscard]] const_span       span    () const noexcept { return _bits.span(); }
+    // --- end accessors ---
+
+    // --- misc utilities ---
+    void ensure_same_universe(finite_set const& o) const { _bits.ensure_eq_length(o._bits); }
+    // --- end misc utilities ---
+
+    /// --- membership ---
+    [[nodiscard]] bool contains(size_t i) const { ensure_member_idx(i); return _bits[i]; }
+    finite_set& insert(size_t i) { ensure_member_idx(i); _bits[i] = true;  return *this; }
+    finite_set& erase (size_t i) { ensure_member_idx(i); _bits[i] = false; return *this; }
+    finite_set& clear ()         { _bits.reset(); return *this; }
+    /// --- end membership ---
+
+    /// --- cardinality ---
+    [[nodiscard]] size_t count() const noexcept { return _bits.count(); }
+    [[nodiscard]] bool   empty() const noexcept { return _bits.none(); }
+    [[nodiscard]] size_t count_union(finite_set const& o) const
+        { ensure_same_universe(o); return span().count_or(o.span()); }
+    [[nodiscard]] size_t count_intersection(finite_set const& o) const
+        { ensure_same_universe(o); return span().count_and(o.span()); }
+    [[nodiscard]] size_t count_difference(finite_set const& o) const
+        { ensure_same_universe(o); return span().count_andnot(o.span()); }
+    [[nodiscard]] size_t count_symmetric_difference(finite_set const& o) const
+        { ensure_same_universe(o); return span().count_xor(o.span()); }
+    /// --- end cardinality ---
+
+    /// --- set predicates ---
+    [[nodiscard]] bool intersects(finite_set const& o) const
+        { ensure_same_universe(o); return span().intersects(o.span()); }
+    [[nodiscard]] bool is_disjoint(finite_set const& o) const
+        { ensure_same_universe(o); return span().is_disjoint(o.span()); }
+    [[nodiscard]] bool is_subset_of(finite_set const& o) const
+        { ensure_same_universe(o); return span().is_subset_of(o.span()); }
+    [[nodiscard]] bool is_superset_of(finite_set const& o) const
+        { ensure_same_universe(o); return span().is_superset_of(o.span()); }
+    /// --- end set predicates ---
+
+    /// --- set algebra, in place ---
+    finite_set& operator |=(finite_set const& o)
+        { ensure_same_universe(o); _bits |= o._bits;       return *this; }
+    finite_set& operator &=(finite_set const& o)
+        { ensure_same_universe(o); _bits &= o._bits;       return *this; }
+    finite_set& operator -=(finite_set const& o)
+        { ensure_same_universe(o); _bits.and_not(o._bits); return *this; }
+    finite_set& operator ^=(finite_set const& o)
+        { ensure_same_universe(o); _bits ^= o._bits;       return *this; }
+    finite_set& complement()
+        { _bits.invert(); _bits.span().clear_residual(); return *this; }
+    /// --- end set algebra, in place ---
+
+    /// --- set algebra ---
+    [[nodiscard]] bool operator==(finite_set const& o) const noexcept { return _bits == o._bits; }
+
+    [[nodiscard]] finite_set operator ~() const
+        { auto rslt = *this; rslt.complement(); return rslt; }
+    [[nodiscard]] finite_set operator |(finite_set const& o) const
+        { ensure_same_universe(o); auto rslt = *this; rslt |= o; return rslt; }
+    [[nodiscard]] finite_set operator &(finite_set const& o) const
+        { ensure_same_universe(o); auto rslt = *this; rslt &= o; return rslt; }
+    [[nodiscard]] finite_set operator -(finite_set const& o) const
+        { ensure_same_universe(o); auto rslt = *this; rslt -= o; return rslt; }
+    [[nodiscard]] finite_set operator ^(finite_set const& o) const
+        { ensure_same_universe(o); auto rslt = *this; rslt ^= o; return rslt; }
+    /// --- end set algebra ---
+};
+
+template<bitspan_word W>
+std::ostream& operator<<(std::ostream& o, finite_set<W> const& s) { return o << s.span(); }
+
+/// --- explicit instantiation ---
+template struct finite_set<>;
+/// --- end explicit instantiation ---
@@ -1,13 +1,38 @@
 #pragma once
+#include <span>
 #include "bitspan_word.hxx"
 
 struct indices;
+struct malloc_alloc;
+struct index_checked;
 
-template<bitspan_word W = default_bitspan_word> struct bitspan;
+template<bitspan_word W = default_bitspan_word, size_t Ext = std::dynamic_extent,
+         typename C = index_checked> struct bitspan;
 template<bitspan_word W = default_bitspan_word> struct bitspan_words;
 template<bool in, bitspan_word W = default_bitspan_word>
     requires (!std::is_const_v<W>) struct bitspan_iter;
-template<bitspan_word W = default_bitspan_word>
+template<bitspan_word W = default_bitspan_word, typename A = malloc_alloc, typename C = index_checked>
     requires (!std::is_const_v<W>) struct bitvec;
-template<bool mut, bitspan_word W = default_bitspan_word>
+template<bool mut, bitspan_word W = default_bitspan_word, typename A = malloc_alloc,
+         typename C = index_checked>
     requires (!std::is_const_v<W>) struct bitvec_words;
+template<bitspan_word W = default_bitspan_word>
+    requires (!std::is_const_v<W>) struct finite_set;
+template<size_t N, bitspan_word W = default_bitspan_word>
+    requires (!std::is_const_v<W>) struct static_bitvec;
+template<size_t N, bitspan_word W = default_bitspan_word>
+    requires (!std::is_const_v<W>) struct small_set;
+template<bitspan_word W = default_bitspan_word>
+    requires (!std::is_const_v<W>) struct cow_bitvec;
+template<bitspan_word W = default_bitspan_word>
+    requires (!std::is_const_v<W>) struct persistent_bitvec;
+template<bitspan_word W = default_bitspan_word, std::unsigned_integral I = uint32_t>
+    requires (!std::is_const_v<W>) struct sparse_set;
+template<bitspan_word W = default_bitspan_word, std::unsigned_integral I = uint32_t>
+    requires (!std::is_const_v<W>) struct hybrid_set;
+template<bitspan_word W = default_bitspan_word>
+    requires (!std::is_const_v<W>) struct summary_bitvec;
+template<bitspan_word W = default_bitspan_word>
+    requires (!std::is_const_v<W>) struct bloom_filter;
+template<bitspan_word W = default_bitspan_word>
+    requires (!std::is_const_v<W>) struct split_block_bloom_filter;
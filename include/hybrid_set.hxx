@@ -0,0 +1,191 @@
+#pragma once
+#include <concepts>
+#include <ostream>
+#include <stdexcept>
+#include <variant>
+#include "finite_set.hxx"
+#include "forward.hxx"
+#include "sparse_set.hxx"
+
+/// Density bounds at which hybrid_set changes representation.  The gap
+/// between them keeps a set hovering near one bound from switching back and
+/// forth on every insert and erase, so hybrid_set requires
+/// 0 <= to_sparse < to_dense <= 1.
+struct hybrid_policy final {
+    double to_dense  = 1.0 / 32;  ///< switch to a bitvec above this fraction of the universe
+    double to_sparse = 1.0 / 128; ///< switch back to sorted indices below this one
+};
+
+/// Set over [0, universe()) that is either a sparse_set or a finite_set,
+/// whichever suits its current density, and picks the cheapest kernel for
+/// each combination of operand representations.
+template<bitspan_word W, std::unsigned_integral I> requires (!std::is_const_v<W>)
+struct hybrid_set final {
+public:
+    // --- type associations ---
+    using word       = W;
+    using sparse_t   = sparse_set<W, I>;
+    using dense_t    = finite_set<W>;
+    using const_span = bitspan<W const>;
+    // --- end type associations ---
+
+private:
+    // --- fields ---
+    std::variant<sparse_t, dense_t> _rep;
+    size_t        _count = 0;
+    hybrid_policy _policy;
+    // --- end fields ---
+
+    [[nodiscard]] sparse_t      & sparse()       { return std::get<sparse_t>(_rep); }
+    [[nodiscard]] sparse_t const& sparse() const { return std::get<sparse_t>(_rep); }
+    [[nodiscard]] dense_t       & dense ()       { return std::get<dense_t >(_rep); }
+    [[nodiscard]] dense_t const & dense () const { return std::get<dense_t >(_rep); }
+
+    [[nodiscard]] double density() const noexcept
+        { return universe() ? double(_count) / double(universe()) : 0; }
+    void rebalance() {
+        if (is_dense()) {
+            if (density() < _policy.to_sparse) _rep = sparse_t(dense().span());
+        } else if (density() > _policy.to_dense) {
+            _rep = dense_t(sparse().to_bitvec());
+        }
+    }
+    hybrid_set& assign(sparse_t s) { _count = s.count(); _rep = std::move(s); rebalance(); return *this; }
+    hybrid_set& assign(dense_t  d) { _count = d.count(); _rep = std::move(d); rebalance(); return *this; }
+    static hybrid_policy checked(hybrid_policy p) {
+        if (!(0 <= p.to_sparse && p.to_sparse < p.to_dense && p.to_dense <= 1))
+            throw std::invalid_argument("hybrid_policy needs 0 <= to_sparse < to_dense <= 1");
+        return p;
+    }
+    void ensure_same_universe(hybrid_set const& o) const
+        { if (universe() != o.universe()) throw bitspan_length_mismatch(); }
+
+    // Copies of the dense operand updated per member of the sparse one.
+    static dense_t dense_with(dense_t d, sparse_t const& s, bool val) {
+        for (I e : s.elements()) val ? d.insert(e) : d.erase(e);
+        return d;
+    }
+    static dense_t dense_flipped(dense_t d, sparse_t const& s) {
+        for (I e : s.elements()) d.contains(e) ? d.erase(e) : d.insert(e);
+        return d;
+    }
+
+public:
+    // --- constructors ---
+    hybrid_set() = default;
+    explicit hybrid_set(size_t universe, hybrid_policy policy = {})
+        : _rep(sparse_t(universe)), _policy(checked(policy)) {}
+    // --- end constructors ---
+
+    // --- accessors ---
+    [[nodiscard]] size_t universe() const noexcept
+        { return std::visit([](auto const& r) { return r.universe(); }, _rep); }
+    [[nodiscard]] bool is_dense() const noexcept { return _rep.index() == 1; }
+    [[nodiscard]] hybrid_policy policy() const noexcept { return _policy; }
+    [[nodiscard]] bitvec<W> to_bitvec() const
+        { return is_dense() ? dense().bits() : sparse().to_bitvec(); }
+    // --- end accessors ---
+
+    /// --- membership ---
+    [[nodiscard]] bool contains(size_t i) const
+        { return std::visit([&](auto const& r) { return r.contains(i); }, _rep); }
+    hybrid_set& insert(size_t i) {
+        if (contains(i)) return *this;
+        std::visit([&](auto& r) { r.insert(i); }, _rep);
+        _count++;
+        rebalance();
+        return *this;
+    }
+    hybrid_set& erase(size_t i) {
+        if (!contains(i)) return *this;
+        std::visit([&](auto& r) { r.erase(i); }, _rep);
+        _count--;
+        rebalance();
+        return *this;
+    }
+    hybrid_set& clear() { return assign(sparse_t(universe())); }
+    /// --- end membership ---
+
+    /// --- cardinality ---
+    [[nodiscard]] size_t count() const noexcept { return _count; }
+    [[nodiscard]] bool   empty() const noexcept { return _count == 0; }
+    [[nodiscard]] size_t count_intersection(hybrid_set const& o) const {
+        ensure_same_universe(o);
+        if (!is_dense())  return o.is_dense() ? sparse().count_intersection(o.dense().span())
+                                              : sparse().count_intersection(o.sparse());
+        if (!o.is_dense()) return o.sparse().count_intersection(dense().span());
+        return dense().count_intersection(o.dense());
+    }
+    [[nodiscard]] size_t count_union(hybrid_set const& o) const
+        { return count() + o.count() - count_intersection(o); }
+    [[nodiscard]] size_t count_difference(hybrid_set const& o) const
+        { return count() - count_intersection(o); }
+    [[nodiscard]] size_t count_symmetric_difference(hybrid_set const& o) const
+        { return count() + o.count() - 2 * count_intersection(o); }
+    /// --- end cardinality ---
+
+    /// --- set predicates ---
+    [[nodiscard]] bool intersects  (hybrid_set const& o) const { return count_intersection(o) != 0; }
+    [[nodiscard]] bool is_disjoint (hybrid_set const& o) const { return !intersects(o); }
+    [[nodiscard]] bool is_subset_of(hybrid_set const& o) const
+        { return count() <= o.count() && count_intersection(o) == count(); }
+    [[nodiscard]] bool is_superset_of(hybrid_set const& o) const { return o.is_subset_of(*this); }
+    /// --- end set predicates ---
+
+    /// --- set algebra ---
+    [[nodiscard]] bool operator==(hybrid_set const& o) const {
+        return universe() == o.universe() && count() == o.count()
+            && count_intersection(o) == count();
+    }
+
+    // sparse op sparse stays on the sorted-array kernels, dense op dense on
+    // the word kernels; mixed operands probe the dense side once per sparse
+    // member, copying it only when the result can be denser than the sparse side.
+    hybrid_set& operator &=(hybrid_set const& o) {
+        ensure_same_universe(o);
+        if (!is_dense()) {
+            if (o.is_dense()) sparse() &= o.dense().span();
+            else              sparse() &= o.sparse();
+            return assign(std::move(sparse()));
+        }
+        if (!o.is_dense()) { auto s = o.sparse(); s &= dense().span(); return assign(std::move(s)); }
+        return assign(dense() & o.dense());
+    }
+    hybrid_set& operator |=(hybrid_set const& o) {
+        ensure_same_universe(o);
+        if (!is_dense() && !o.is_dense()) return assign(sparse() | o.sparse());
+        if (!is_dense()) return assign(dense_with(o.dense(), sparse(), true));
+        if (!o.is_dense()) return assign(dense_with(std::move(dense()), o.sparse(), true));
+        return assign(dense() | o.dense());
+    }
+    hybrid_set& operator -=(hybrid_set const& o) {
+        ensure_same_universe(o);
+        if (!is_dense()) {
+            if (o.is_dense()) sparse() -= o.dense().span();
+            else              sparse() -= o.sparse();
+            return assign(std::move(sparse()));
+        }
+        if (!o.is_dense()) return assign(dense_with(std::move(dense()), o.sparse(), false));
+        return assign(dense() - o.dense());
+    }
+    hybrid_set& operator ^=(hybrid_set const& o) {
+        ensure_same_universe(o);
+        if (!is_dense() && !o.is_dense()) return assign(sparse() ^ o.sparse());
+        if (!is_dense()) return assign(dense_flipped(o.dense(), sparse()));
+        if (!o.is_dense()) return assign(dense_flipped(std::move(dense()), o.sparse()));
+        return assign(dense() ^ o.dense());
+    }
+
+    [[nodiscard]] hybrid_set operator &(hybrid_set const& o) const { auto r = *this; r &= o; return r; }
+    [[nodiscard]] hybrid_set operator |(hybrid_set const& o) const { auto r = *this; r |= o; return r; }
+    [[nodiscard]] hybrid_set operator -(hybrid_set const& o) const { auto r = *this; r -= o; return r; }
+    [[nodiscard]] hybrid_set operator ^(hybrid_set const& o) const { auto r = *this; r ^= o; return r; }
+    /// --- end set algebra ---
+};
+
+template<bitspan_word W, std::unsigned_integral I>
+std::ostream& operator<<(std::ostream& o, hybrid_set<W, I> const& s) { return o << s.to_bitvec(); }
+
+/// --- explicit instantiation ---
+template struct hybrid_set<>;
+/// --- end explicit instantiation ---
@@ -0,0 +1,27 @@
+#pragma once
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <stdexcept>
+
+/// Indexing policies of bitspan and bitvec: check(i, len) is called with
+/// every index before it is used.  The policy only affects single-bit and
+/// batched indexing; bulk operations have no indices to check.
+template<typename C>
+concept index_check = requires(size_t i) { C::check(i, i); };
+
+/// Throws std::out_of_range; the default.
+struct index_checked final {
+    static constexpr void check(size_t i, size_t len)
+        { if (i >= len) throw std::out_of_range("bitspan index out of range"); }
+};
+/// Trusts the caller, leaving nothing in the indexing path to keep loops
+/// from vectorizing.
+struct index_unchecked final {
+    static constexpr void check(size_t, size_t) noexcept {}
+};
+/// assert()s, so debug builds trap and NDEBUG builds are unchecked.
+struct index_asserted final {
+    static constexpr void check([[maybe_unused]] size_t i, [[maybe_unused]] size_t len) noexcept
+        { assert(i < len); }
+};
@@ -0,0 +1,284 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include "bitspan.hxx"
+#include "bitvec.hxx"
+#include "forward.hxx"
+#include "word_kernels.hxx"
+
+/// Immutable bit vector stored as a shallow 64-ary tree over fixed-size leaf
+/// chunks.  Every update returns a new version that path-copies the touched
+/// leaf and its ancestors and shares everything else with the old version.
+///
+/// The tree is kept canonical: a null pointer stands for an all-zero subtree,
+/// no stored subtree is all zero, and bits past len() are zero.  Two versions
+/// are therefore equal iff their trees match, and any pair of identical
+/// subtree pointers is known equal without looking at the bits below.
+template<bitspan_word W> requires (!std::is_const_v<W>)
+struct persistent_bitvec final {
+public:
+    // --- type associations ---
+    using word       = W;
+    using const_span = bitspan<W const>;
+    using mut_span   = bitspan<W>;
+    // --- end type associations ---
+
+    // --- constants ---
+    static constexpr size_t bits_per_word = const_span::bits_per_word;
+    static constexpr size_t leaf_bytes    = 512;
+    static constexpr size_t leaf_words    = leaf_bytes / sizeof(W);
+    static constexpr size_t leaf_bits     = leaf_words * bits_per_word;
+    static constexpr size_t fanout_shift  = 6;
+    static constexpr size_t fanout        = size_t(1) << fanout_shift;
+    // --- end constants ---
+
+private:
+    // --- fields ---
+    // Nodes are either leaves or inner nodes; which one is known from the
+    // height of the subtree, so they share one type-erased pointer.
+    struct leaf  final { std::array<W, leaf_words> words {}; };
+    using node_ptr = std::shared_ptr<void const>;
+    struct inner final { std::array<node_ptr, fanout> kids {}; };
+
+    node_ptr _root;
+    size_t   _len    = 0;
+    size_t   _height = 0; // number of inner levels above the leaves
+    // --- end fields ---
+
+    // --- tree helpers ---
+    static leaf  const& as_leaf (node_ptr const& p) noexcept { return *static_cast<leaf  const*>(p.get()); }
+    static inner const& as_inner(node_ptr const& p) noexcept { return *static_cast<inner const*>(p.get()); }
+    static leaf  const& zero_leaf() noexcept { static leaf const z {}; return z; }
+    static size_t child_idx(size_t c, size_t h) noexcept
+        { return (c >> (fanout_shift * (h - 1))) & (fanout - 1); }
+
+    [[nodiscard]] size_t leaf_count() const noexcept { return (_len + leaf_bits - 1) / leaf_bits; }
+    void ensure_idx(size_t i) const
+        { if (i >= _len) throw std::out_of_range("persistent_bitvec index out of range"); }
+    void ensure_same_length(persistent_bitvec const& o) const
+        { if (_len != o._len) throw bitspan_length_mismatch(); }
+
+    static node_ptr normalized(std::shared_ptr<leaf> l) {
+        if (mut_span(l->words).none()) return nullptr;
+        return l;
+    }
+    static node_ptr normalized(std::shared_ptr<inner> n) {
+        for (auto const& k : n->kids) if (k) return n;
+        return nullptr;
+    }
+
+    /// Path-copies down to leaf c and lets f rewrite it in place.
+    template<typename F>
+    static node_ptr update(node_ptr const& p, size_t h, size_t c, F& f) {
+        if (h == 0) {
+            auto l = p ? std::make_shared<leaf>(as_leaf(p)) : std::make_shared<leaf>();
+            f(*l);
+            return normalized(std::move(l));
+        }
+        auto n = p ? std::make_shared<inner>(as_inner(p)) : std::make_shared<inner>();
+        auto& kid = n->kids[child_idx(c, h)];
+        kid = update(kid, h - 1, c, f);
+        return normalized(std::move(n));
+    }
+
+    // Null operands and shared subtrees are resolved from what Op does to
+    // zero and to equal words, without descending: x & 0 = 0, x | 0 = x,
+    // x ^ x = 0, and so on.
+    template<typename Op, typename SpanOp>
+    static node_ptr combine(node_ptr const& a, node_ptr const& b, size_t h, SpanOp& span_op) {
+        constexpr W ones = W(~W(0));
+        if (a == b)  return Op::apply(ones, ones) == 0 ? nullptr : a;
+        if (a == nullptr) return Op::apply(W(0), ones) == 0 ? nullptr : b;
+        if (b == nullptr) return Op::apply(ones, W(0)) == 0 ? nullptr : a;
+        if (h == 0) {
+            auto l = std::make_shared<leaf>(as_leaf(a));
+            span_op(mut_span(l->words), const_span(as_leaf(b).words));
+            return normalized(std::move(l));
+        }
+        auto n = std::make_shared<inner>();
+        for (size_t k = 0; k < fanout; k++)
+            n->kids[k] = combine<Op>(as_inner(a).kids[k], as_inner(b).kids[k], h - 1, span_op);
+        return normalized(std::move(n));
+    }
+
+    /// Complement of the subtree holding leaves [first, first + fanout^h).
+    /// Null leaves become a single all-ones leaf shared between them.
+    node_ptr complement(node_ptr const& p, size_t h, size_t first, node_ptr const& ones) const {
+        if (first >= leaf_count()) return nullptr;
+        if (h == 0) {
+            bool last = first == leaf_count() - 1 && _len % leaf_bits != 0;
+            if (p == nullptr && !last) return ones;
+            auto l = p ? std::make_shared<leaf>(as_leaf(p)) : std::make_shared<leaf>();
+            mut_span span(l->words.data(), last ? _len % leaf_bits : leaf_bits);
+            span.invert();
+            span.clear_residual();
+            return normalized(std::move(l));
+        }
+        auto n = std::make_shared<inner>();
+        size_t step = size_t(1) << (fanout_shift * (h - 1));
+        for (size_t k = 0; k < fanout; k++)
+            n->kids[k] = complement(p ? as_inner(p).kids[k] : nullptr, h - 1, first + k * step, ones);
+        return normalized(std::move(n));
+    }
+
+    /// Subtree holding leaves [first, first + fanout^h) of o, built once
+    /// from the leaves up rather than by path-copying one leaf at a time.
+    node_ptr build(const_span o, size_t h, size_t first) const {
+        if (first >= leaf_count()) return nullptr;
+        if (h == 0) {
+            const_span part(o.words().begin() + first * leaf_words, chunk_len(first));
+            if (part.none()) return nullptr;
+            auto l = std::make_shared<leaf>();
+            mut_span(l->words.data(), part.len()).set_from(part);
+            return l;
+        }
+        auto n = std::make_shared<inner>();
+        size_t step = size_t(1) << (fanout_shift * (h - 1));
+        for (size_t k = 0; k < fanout; k++) n->kids[k] = build(o, h - 1, first + k * step);
+        return normalized(std::move(n));
+    }
+
+    static bool equal(node_ptr const& a, node_ptr const& b, size_t h) noexcept {
+        if (a == b) return true;
+        if (a == nullptr || b == nullptr) return false;
+        if (h == 0) return as_leaf(a).words == as_leaf(b).words;
+        for (size_t k = 0; k < fanout; k++)
+            if (!equal(as_inner(a).kids[k], as_inner(b).kids[k], h - 1)) return false;
+        return true;
+    }
+    static size_t count(node_ptr const& p, size_t h) noexcept {
+        if (p == nullptr) return 0;
+        if (h == 0) return const_span(as_leaf(p).words).count();
+        size_t total = 0;
+        for (auto const& k : as_inner(p).kids) total += count(k, h - 1);
+        return total;
+    }
+    template<typename F>
+    static void for_each_leaf(node_ptr const& p, size_t h, size_t first, F& f) {
+        if (p == nullptr) return;
+        if (h == 0) return f(first, as_leaf(p));
+        size_t step = size_t(1) << (fanout_shift * (h - 1));
+        for (size_t k = 0; k < fanout; k++)
+            for_each_leaf(as_inner(p).kids[k], h - 1, first + k * step, f);
+    }
+
+    template<typename Op, typename SpanOp>
+    [[nodiscard]] persistent_bitvec binary(persistent_bitvec const& o, SpanOp span_op) const {
+        ensure_same_length(o);
+        persistent_bitvec rslt = *this;
+        rslt._root = combine<Op>(_root, o._root, _height, span_op);
+        return rslt;
+    }
+    // --- end tree helpers ---
+
+public:
+    // --- constructors ---
+    persistent_bitvec() noexcept = default;
+    /// An all-zero vector, which takes no storage.
+    explicit persistent_bitvec(size_t len) : _len(len) {
+        for (size_t reach = 1; reach < leaf_count(); reach <<= fanout_shift) _height++;
+    }
+    explicit persistent_bitvec(const_span o) : persistent_bitvec(o.len())
+        { _root = build(o, _height, 0); }
+    // --- end constructors ---
+
+    // --- accessors ---
+    [[nodiscard]] size_t len()         const noexcept { return _len; }
+    [[nodiscard]] size_t chunk_count() const noexcept { return leaf_count(); }
+    [[nodiscard]] size_t chunk_len(size_t c) const noexcept
+        { return std::min(leaf_bits, _len - c * leaf_bits); }
+    /// The bits of chunk c; an all-zero chunk is backed by a shared zero leaf.
+    [[nodiscard]] const_span chunk_span(size_t c) const noexcept {
+        node_ptr const* p = &_root;
+        for (size_t h = _height; h > 0 && *p; h--) p = &as_inner(*p).kids[child_idx(c, h)];
+        leaf const& l = *p ? as_leaf(*p) : zero_leaf();
+        return const_span(l.words.data(), chunk_len(c));
+    }
+    /// Whether chunk c is stored in the same leaf in both versions (or is
+    /// zero in both).
+    [[nodiscard]] bool shares_chunk_with(persistent_bitvec const& o, size_t c) const noexcept
+        { return chunk_span(c).words().begin() == o.chunk_span(c).words().begin(); }
+    // --- end accessors ---
+
+    /// --- indexing ---
+    [[nodiscard]] bool operator[](size_t i) const
+        { ensure_idx(i); return chunk_span(i / leaf_bits)[i % leaf_bits]; }
+    /// --- end indexing ---
+
+    /// --- updates ---
+    /// A new version with chunk c rewritten by f(mut_span).  Bits written
+    /// past the chunk's length are discarded.
+    template<typename F>
+    [[nodiscard]] persistent_bitvec update_chunk(size_t c, F f) const {
+        if (c >= leaf_count()) throw std::out_of_range("persistent_bitvec chunk out of range");
+        auto edit = [&](leaf& l) {
+            mut_span s(l.words.data(), chunk_len(c));
+            f(s);
+            s.clear_residual();
+        };
+        persistent_bitvec rslt = *this;
+        rslt._root = update(_root, _height, c, edit);
+        return rslt;
+    }
+    [[nodiscard]] persistent_bitvec set(size_t i, bool val = true) const {
+        if ((*this)[i] == val) return *this;
+        return update_chunk(i / leaf_bits, [&](mut_span s) { s[i % leaf_bits] = val; });
+    }
+    [[nodiscard]] persistent_bitvec reset(size_t i) const { return set(i, false); }
+    /// --- end updates ---
+
+    /// --- bulk bitwise operations ---
+    [[nodiscard]] bool operator ==(persistent_bitvec const& o) const noexcept
+        { return _len == o._len && equal(_root, o._root, _height); }
+
+    [[nodiscard]] persistent_bitvec operator &(persistent_bitvec const& o) const
+        { return binary<word_op_and>   (o, [](mut_span d, const_span s) { d &= s; }); }
+    [[nodiscard]] persistent_bitvec operator |(persistent_bitvec const& o) const
+        { return binary<word_op_or>    (o, [](mut_span d, const_span s) { d |= s; }); }
+    [[nodiscard]] persistent_bitvec operator ^(persistent_bitvec const& o) const
+        { return binary<word_op_xor>   (o, [](mut_span d, const_span s) { d ^= s; }); }
+    [[nodiscard]] persistent_bitvec and_not   (persistent_bitvec const& o) const
+        { return binary<word_op_andnot>(o, [](mut_span d, const_span s) { d.and_not(s); }); }
+    [[nodiscard]] persistent_bitvec operator ~() const {
+        auto ones = std::make_shared<leaf>();
+        ones->words.fill(W(~W(0)));
+        persistent_bitvec rslt = *this;
+        rslt._root = complement(_root, _height, 0, ones);
+        return rslt;
+    }
+    /// --- end bulk bitwise operations ---
+
+    /// --- set predicates and counting ---
+    [[nodiscard]] size_t count() const noexcept { return count(_root, _height); }
+    [[nodiscard]] bool   any  () const noexcept { return _root != nullptr; }
+    [[nodiscard]] bool   none () const noexcept { return _root == nullptr; }
+    /// --- end set predicates and counting ---
+
+    /// --- conversions ---
+    /// Calls f(c, span) for every chunk that has a bit set, in order.
+    template<typename F>
+    void for_each_chunk(F f) const {
+        auto visit = [&](size_t c, leaf const& l) { f(c, const_span(l.words.data(), chunk_len(c))); };
+        for_each_leaf(_root, _height, 0, visit);
+    }
+    [[nodiscard]] bitvec<W> to_bitvec() const {
+        bitvec<W> rslt(_len);
+        for_each_chunk([&](size_t c, const_span s)
+            { mut_span(rslt.words().begin() + c * leaf_words, s.len()).set_from(s); });
+        return rslt;
+    }
+    /// --- end conversions ---
+};
+
+template<bitspan_word W>
+std::ostream& operator<<(std::ostream& o, persistent_bitvec<W> const& b) {
+    for (size_t c = 0; c < b.chunk_count() && o; c++) o << b.chunk_span(c);
+    return o;
+}
+
+/// --- explicit instantiation ---
+template struct persistent_bitvec<>;
+/// --- end explicit instantiation ---
@@ -0,0 +1,200 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include "bitspan.hxx"
+#include "forward.hxx"
+
+#if defined(__SIZEOF_INT128__)
+#define FINITESETS_HAS_INT128 1
+#else
+#define FINITESETS_HAS_INT128 0
+#endif
+
+/// Set over the compile-time universe [0, N) for N up to 64 (or 128 where the
+/// compiler has unsigned __int128), held in a single integer register.  It
+/// offers the finite_set interface, but every operation is a handful of
+/// branch-free register instructions; the only branch is the universe check.
+/// The register is stored as words of W so it can be viewed as a bitspan.
+template<size_t N, bitspan_word W> requires (!std::is_const_v<W>)
+struct small_set final {
+public:
+    // --- type associations ---
+#if FINITESETS_HAS_INT128
+    using reg_t = std::conditional_t<(N <= 64), uint64_t, unsigned __int128>;
+    static_assert(N <= 128, "small_set holds at most 128 elements");
+#else
+    using reg_t = uint64_t;
+    static_assert(N <= 64, "small_set holds at most 64 elements on this compiler");
+#endif
+    using word       = W;
+    using const_span = bitspan<W const, N>;
+    using mut_span   = bitspan<W,       N>;
+    static_assert(N > 0 && sizeof(W) <= sizeof(reg_t));
+    // --- end type associations ---
+
+    // --- constants ---
+    static constexpr size_t reg_bits   = std::numeric_limits<reg_t>::digits;
+    static constexpr size_t word_count = sizeof(reg_t) / sizeof(W);
+    static constexpr reg_t  universe_mask = ~reg_t(0) >> (reg_bits - N);
+    // --- end constants ---
+
+private:
+    // --- fields ---
+    // Bits at and above N are always zero
+    alignas(reg_t) std::array<W, word_count> _words {};
+    // --- end fields ---
+
+    [[nodiscard]] constexpr reg_t reg() const noexcept { return std::bit_cast<reg_t>(_words); }
+    constexpr void store(reg_t r) noexcept { _words = std::bit_cast<decltype(_words)>(r); }
+    static constexpr void ensure_member_idx(size_t i)
+        { if (i >= N) throw std::out_of_range("small_set element out of universe"); }
+
+public:
+    // Lowest set bit and population count, including the 128-bit register
+    [[nodiscard]] static constexpr size_t countr_zero(reg_t r) noexcept {
+        if constexpr (reg_bits == 64) return std::countr_zero(r);
+        else {
+            auto lo = static_cast<uint64_t>(r), hi = static_cast<uint64_t>(r >> 64);
+            return lo != 0 ? std::countr_zero(lo) : 64 + std::countr_zero(hi);
+        }
+    }
+    [[nodiscard]] static constexpr size_t popcount(reg_t r) noexcept {
+        if constexpr (reg_bits == 64) return std::popcount(r);
+        else return std::popcount(static_cast<uint64_t>(r))
+                  + std::popcount(static_cast<uint64_t>(r >> 64));
+    }
+
+    // --- constructors ---
+    constexpr small_set() noexcept = default;
+    constexpr small_set(std::initializer_list<size_t> elems) { for (auto e : elems) insert(e); }
+    /// Copies the members of a bitspan of exactly N bits.
+    explicit small_set(bitspan<W const> o) {
+        if (o.len() != N) throw bitspan_length_mismatch();
+        span().set_from(o);
+    }
+    [[nodiscard]] static constexpr small_set from_reg(reg_t r) noexcept
+        { small_set s; s.store(r & universe_mask); return s; }
+    // --- end constructors ---
+
+    // --- accessors ---
+    [[nodiscard]] static constexpr size_t universe() noexcept { return N; }
+    [[nodiscard]] constexpr reg_t bits() const noexcept { return reg(); }
+    // --- end accessors ---
+
+    // --- span acquisition ---
+    [[nodiscard]] constexpr operator const_span() const & noexcept
+        { return const_span(_words.data()); }
+    [[nodiscard]] operator bitspan<W const>() const & noexcept
+        { return bitspan<W const>(_words.data(), N); }
+    [[nodiscard]] operator const_span() && = delete;
+    [[nodiscard]] operator bitspan<W const>() && = delete;
+
+    [[nodiscard]] constexpr const_span span() const & noexcept { return *this; }
+    [[nodiscard]] const_span span() && = delete;
+    /// Writes through this view must leave bits at and above N clear.
+    [[nodiscard]] constexpr mut_span span() & noexcept { return mut_span(_words.data()); }
+    // --- end span acquisition ---
+
+    /// --- membership ---
+    [[nodiscard]] constexpr bool contains(size_t i) const
+        { ensure_member_idx(i); return (reg() >> i) & 1; }
+    constexpr small_set& insert(size_t i)
+        { ensure_member_idx(i); store(reg() |  (reg_t(1) << i)); return *this; }
+    constexpr small_set& erase (size_t i)
+        { ensure_member_idx(i); store(reg() & ~(reg_t(1) << i)); return *this; }
+    constexpr small_set& assign(size_t i, bool val) {
+        ensure_member_idx(i);
+        store((reg() & ~(reg_t(1) << i)) | (reg_t(val) << i));
+        return *this;
+    }
+    constexpr small_set& clear () noexcept { store(0); return *this; }
+    /// --- end membership ---
+
+    /// --- cardinality ---
+    [[nodiscard]] constexpr size_t count() const noexcept { return popcount(reg()); }
+    [[nodiscard]] constexpr bool   empty() const noexcept { return reg() == 0; }
+    [[nodiscard]] constexpr size_t count_union(small_set o) const noexcept
+        { return popcount(reg() | o.reg()); }
+    [[nodiscard]] constexpr size_t count_intersection(small_set o) const noexcept
+        { return popcount(reg() & o.reg()); }
+    [[nodiscard]] constexpr size_t count_difference(small_set o) const noexcept
+        { return popcount(reg() & ~o.reg()); }
+    [[nodiscard]] constexpr size_t count_symmetric_difference(small_set o) const noexcept
+        { return popcount(reg() ^ o.reg()); }
+    /// --- end cardinality ---
+
+    /// --- set predicates ---
+    [[nodiscard]] constexpr bool intersects    (small_set o) const noexcept
+        { return (reg() & o.reg()) != 0; }
+    [[nodiscard]] constexpr bool is_disjoint   (small_set o) const noexcept
+        { return (reg() & o.reg()) == 0; }
+    [[nodiscard]] constexpr bool is_subset_of  (small_set o) const noexcept
+        { return (reg() & ~o.reg()) == 0; }
+    [[nodiscard]] constexpr bool is_superset_of(small_set o) const noexcept
+        { return o.is_subset_of(*this); }
+    /// --- end set predicates ---
+
+    /// --- set algebra, in place ---
+    constexpr small_set& operator |=(small_set o) noexcept { store(reg() |  o.reg()); return *this; }
+    constexpr small_set& operator &=(small_set o) noexcept { store(reg() &  o.reg()); return *this; }
+    constexpr small_set& operator -=(small_set o) noexcept { store(reg() & ~o.reg()); return *this; }
+    constexpr small_set& operator ^=(small_set o) noexcept { store(reg() ^  o.reg()); return *this; }
+    constexpr small_set& complement() noexcept { store(~reg() & universe_mask); return *this; }
+    /// --- end set algebra, in place ---
+
+    /// --- set algebra ---
+    [[nodiscard]] constexpr bool operator==(small_set const& o) const noexcept
+        { return reg() == o.reg(); }
+
+    [[nodiscard]] constexpr small_set operator ~() const noexcept
+        { return from_reg(~reg()); }
+    [[nodiscard]] constexpr small_set operator |(small_set o) const noexcept
+        { return from_reg(reg() |  o.reg()); }
+    [[nodiscard]] constexpr small_set operator &(small_set o) const noexcept
+        { return from_reg(reg() &  o.reg()); }
+    [[nodiscard]] constexpr small_set operator -(small_set o) const noexcept
+        { return from_reg(reg() & ~o.reg()); }
+    [[nodiscard]] constexpr small_set operator ^(small_set o) const noexcept
+        { return from_reg(reg() ^  o.reg()); }
+    /// --- end set algebra ---
+
+    /// --- iteration ---
+    struct iter final {
+    private:
+        reg_t rest;
+    public:
+        constexpr explicit iter(reg_t r) noexcept : rest(r) {}
+        /// Members in increasing order, then nullopt.
+        constexpr std::optional<size_t> next() noexcept {
+            if (rest == 0) return std::nullopt;
+            size_t i = countr_zero(rest);
+            rest &= rest - 1;
+            return i;
+        }
+    };
+    [[nodiscard]] constexpr iter members() const noexcept { return iter(reg()); }
+    /// Smallest member, or N if the set is empty.
+    [[nodiscard]] constexpr size_t min() const noexcept
+        { return empty() ? N : countr_zero(reg()); }
+
+    template<typename F>
+    constexpr void for_each(F f) const {
+        for (reg_t r = reg(); r != 0; r &= r - 1) f(countr_zero(r));
+    }
+    /// --- end iteration ---
+};
+
+template<size_t N, bitspan_word W>
+std::ostream& operator<<(std::ostream& o, small_set<N, W> const& s) { return o << s.span(); }
+
+/// --- explicit instantiation ---
+template struct small_set<64>;
+#if FINITESETS_HAS_INT128
+template struct small_set<128>;
+#endif
+/// --- end explicit instantiation ---
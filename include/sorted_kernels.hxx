@@ -0,0 +1,164 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/// Set operations over strictly increasing arrays of indices, backing
+/// sparse_set.  Outputs are written to caller-provided buffers, which must
+/// hold min(na, nb) elements for intersections and na + nb for unions; every
+/// function returns the number of elements written.
+template<std::unsigned_integral I>
+struct sorted_kernels final {
+    /// Operands whose sizes differ by more than this factor are combined by
+    /// galloping through the larger one instead of merging.
+    static constexpr size_t gallop_ratio = 32;
+
+    /// First element of [first, last) not less than v, found by doubling the
+    /// step from first and then bisecting; cheap when the answer is near.
+    [[nodiscard]] static I const* gallop(I const* first, I const* last, I v) noexcept {
+        size_t n = last - first, step = 1, lo = 0;
+        while (step < n && first[step] < v) { lo = step; step <<= 1; }
+        return std::lower_bound(first + lo, first + std::min(step + 1, n), v);
+    }
+
+    /// --- intersection ---
+#if defined(__AVX2__)
+    // Compares a block of 8 from each side all-against-all with 8 rotations
+    // of b, emits the matches from a, then advances whichever block ends
+    // first (both if they end on the same value).
+    static size_t intersect_avx2(I const*& a, I const* a_end, I const*& b, I const* b_end,
+                                 I* out) noexcept requires(sizeof(I) == 4) {
+        I* o = out;
+        const __m256i rot = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+        while (a + 8 <= a_end && b + 8 <= b_end) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b));
+            __m256i eq = _mm256_cmpeq_epi32(va, vb);
+            for (int r = 1; r < 8; r++) {
+                vb = _mm256_permutevar8x32_epi32(vb, rot);
+                eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(va, vb));
+            }
+            for (unsigned m = _mm256_movemask_ps(_mm256_castsi256_ps(eq)); m != 0; m &= m - 1)
+                *o++ = a[std::countr_zero(m)];
+            I amax = a[7], bmax = b[7];
+            if (amax <= bmax) a += 8;
+            if (bmax <= amax) b += 8;
+        }
+        return o - out;
+    }
+#endif
+    static size_t intersect(I const* a, size_t na, I const* b, size_t nb, I* out) noexcept {
+        if (na > nb) { std::swap(a, b); std::swap(na, nb); }
+        I const *a_end = a + na, *b_end = b + nb;
+        I* o = out;
+        if (na * gallop_ratio < nb) {
+            for (; a != a_end && b != b_end; a++) {
+                b = gallop(b, b_end, *a);
+                if (b != b_end && *b == *a) *o++ = *a;
+            }
+            return o - out;
+        }
+#if defined(__AVX2__)
+        if constexpr (sizeof(I) == 4) o += intersect_avx2(a, a_end, b, b_end, o);
+#endif
+        while (a != a_end && b != b_end) {
+            I x = *a, y = *b;
+            if (x == y) *o++ = x;
+            a += x <= y;
+            b += y <= x;
+        }
+        return o - out;
+    }
+    [[nodiscard]] static size_t intersect_count(I const* a, size_t na, I const* b, size_t nb) noexcept {
+        if (na > nb) { std::swap(a, b); std::swap(na, nb); }
+        I const *a_end = a + na, *b_end = b + nb;
+        size_t total = 0;
+        if (na * gallop_ratio < nb) {
+            for (; a != a_end && b != b_end; a++) {
+                b = gallop(b, b_end, *a);
+                total += b != b_end && *b == *a;
+            }
+            return total;
+        }
+        while (a != a_end && b != b_end) {
+            I x = *a, y = *b;
+            total += x == y;
+            a += x <= y;
+            b += y <= x;
+        }
+        return total;
+    }
+    /// --- end intersection ---
+
+    /// --- union and differences ---
+    static size_t unite(I const* a, size_t na, I const* b, size_t nb, I* out) noexcept {
+        if (na > nb) { std::swap(a, b); std::swap(na, nb); }
+        I const *a_end = a + na, *b_end = b + nb;
+        I* o = out;
+        if (na * gallop_ratio < nb) {
+            // Copy the larger operand in runs between the smaller one's elements
+            for (; a != a_end; a++) {
+                I const* run_end = gallop(b, b_end, *a);
+                o = std::copy(b, run_end, o);
+                b = run_end;
+                *o++ = *a;
+                b += b != b_end && *b == *a;
+            }
+            return std::copy(b, b_end, o) - out;
+        }
+        while (a != a_end && b != b_end) {
+            I x = *a, y = *b;
+            *o++ = std::min(x, y);
+            a += x <= y;
+            b += y <= x;
+        }
+        o = std::copy(a, a_end, o);
+        return std::copy(b, b_end, o) - out;
+    }
+    /// Elements of a that are not in b.
+    static size_t difference(I const* a, size_t na, I const* b, size_t nb, I* out) noexcept {
+        I const *a_end = a + na, *b_end = b + nb;
+        I* o = out;
+        if (na * gallop_ratio < nb) {
+            for (; a != a_end; a++) {
+                b = gallop(b, b_end, *a);
+                if (b == b_end || *b != *a) *o++ = *a;
+            }
+            return o - out;
+        }
+        if (nb * gallop_ratio < na) {
+            for (; b != b_end; b++) {
+                I const* run_end = gallop(a, a_end, *b);
+                o = std::copy(a, run_end, o);
+                a = run_end + (run_end != a_end && *run_end == *b);
+            }
+            return std::copy(a, a_end, o) - out;
+        }
+        while (a != a_end && b != b_end) {
+            I x = *a, y = *b;
+            if (x < y) *o++ = x;
+            a += x <= y;
+            b += y <= x;
+        }
+        return std::copy(a, a_end, o) - out;
+    }
+    static size_t symmetric_difference(I const* a, size_t na, I const* b, size_t nb, I* out) noexcept {
+        I const *a_end = a + na, *b_end = b + nb;
+        I* o = out;
+        while (a != a_end && b != b_end) {
+            I x = *a, y = *b;
+            if (x != y) *o++ = std::min(x, y);
+            a += x <= y;
+            b += y <= x;
+        }
+        o = std::copy(a, a_end, o);
+        return std::copy(b, b_end, o) - out;
+    }
+    /// --- end union and differences ---
+};
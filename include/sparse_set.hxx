@@ -0,0 +1,186 @@
+#pragma once
+#include <algorithm>
+#include <concepts>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include "bitspan.hxx"
+#include "bitvec.hxx"
+#include "forward.hxx"
+#include "sorted_kernels.hxx"
+
+/// Set of elements drawn from the universe [0, universe()), stored as a
+/// strictly increasing array of indices of type I.  Memory and the cost of
+/// every operation scale with the number of members rather than with the
+/// universe.  Dense operands are accepted as bitspans over words of W.
+template<bitspan_word W, std::unsigned_integral I> requires (!std::is_const_v<W>)
+struct sparse_set final {
+public:
+    // --- type associations ---
+    using word       = W;
+    using index      = I;
+    using kernels    = sorted_kernels<I>;
+    using const_span = bitspan<W const>;
+    using mut_span   = bitspan<W>;
+    // --- end type associations ---
+
+private:
+    // --- fields ---
+    std::vector<I> _elems;
+    size_t         _universe = 0;
+    // --- end fields ---
+
+    void ensure_member_idx(size_t i) const
+        { if (i >= _universe) throw std::out_of_range("sparse_set element out of universe"); }
+    void ensure_universe_fits() const {
+        if (_universe != 0 && _universe - 1 > std::numeric_limits<I>::max())
+            throw std::length_error("sparse_set universe exceeds its index type");
+    }
+    template<typename F>
+    [[nodiscard]] sparse_set combine(sparse_set const& o, size_t cap, F f) const {
+        ensure_same_universe(o);
+        sparse_set rslt(_universe);
+        rslt._elems.resize(cap);
+        rslt._elems.resize(f(_elems.data(), _elems.size(), o._elems.data(), o._elems.size(),
+                             rslt._elems.data()));
+        return rslt;
+    }
+
+public:
+    // --- constructors ---
+    sparse_set() noexcept = default;
+    explicit sparse_set(size_t universe) : _universe(universe) { ensure_universe_fits(); }
+    /// The set bits of a dense span, whose length becomes the universe.
+    explicit sparse_set(const_span dense) : sparse_set(dense.len()) {
+        _elems.reserve(dense.count());
+        for (auto it = dense.template iter<true>(); auto i = it.next();) _elems.push_back(I(*i));
+    }
+    // --- end constructors ---
+
+    // --- accessors ---
+    [[nodiscard]] size_t universe() const noexcept { return _universe; }
+    [[nodiscard]] std::span<I const> elements() const noexcept { return _elems; }
+    // --- end accessors ---
+
+    // --- misc utilities ---
+    void ensure_same_universe(sparse_set const& o) const
+        { if (_universe != o._universe) throw bitspan_length_mismatch(); }
+    void ensure_same_universe(const_span o) const
+        { if (_universe != o.len()) throw bitspan_length_mismatch(); }
+    // --- end misc utilities ---
+
+    /// --- membership ---
+    [[nodiscard]] bool contains(size_t i) const {
+        ensure_member_idx(i);
+        return std::binary_search(_elems.begin(), _elems.end(), I(i));
+    }
+    sparse_set& insert(size_t i) {
+        ensure_member_idx(i);
+        auto pos = std::lower_bound(_elems.begin(), _elems.end(), I(i));
+        if (pos == _elems.end() || *pos != I(i)) _elems.insert(pos, I(i));
+        return *this;
+    }
+    sparse_set& erase(size_t i) {
+        ensure_member_idx(i);
+        auto pos = std::lower_bound(_elems.begin(), _elems.end(), I(i));
+        if (pos != _elems.end() && *pos == I(i)) _elems.erase(pos);
+        return *this;
+    }
+    sparse_set& clear() noexcept { _elems.clear(); return *this; }
+    /// --- end membership ---
+
+    /// --- cardinality ---
+    [[nodiscard]] size_t count() const noexcept { return _elems.size(); }
+    [[nodiscard]] bool   empty() const noexcept { return _elems.empty(); }
+    [[nodiscard]] size_t count_intersection(sparse_set const& o) const {
+        ensure_same_universe(o);
+        return kernels::intersect_count(_elems.data(), _elems.size(), o._elems.data(), o._elems.size());
+    }
+    [[nodiscard]] size_t count_union(sparse_set const& o) const
+        { return count() + o.count() - count_intersection(o); }
+    [[nodiscard]] size_t count_difference(sparse_set const& o) const
+        { return count() - count_intersection(o); }
+    [[nodiscard]] size_t count_symmetric_difference(sparse_set const& o) const
+        { return count() + o.count() - 2 * count_intersection(o); }
+    /// --- end cardinality ---
+
+    /// --- set predicates ---
+    [[nodiscard]] bool intersects(sparse_set const& o) const { return count_intersection(o) != 0; }
+    [[nodiscard]] bool is_disjoint(sparse_set const& o) const { return !intersects(o); }
+    [[nodiscard]] bool is_subset_of(sparse_set const& o) const
+        { return count_intersection(o) == count(); }
+    [[nodiscard]] bool is_superset_of(sparse_set const& o) const { return o.is_subset_of(*this); }
+    /// --- end set predicates ---
+
+    /// --- set algebra ---
+    [[nodiscard]] bool operator==(sparse_set const& o) const noexcept
+        { return _universe == o._universe && _elems == o._elems; }
+
+    [[nodiscard]] sparse_set operator &(sparse_set const& o) const
+        { return combine(o, std::min(count(), o.count()), kernels::intersect); }
+    [[nodiscard]] sparse_set operator |(sparse_set const& o) const
+        { return combine(o, count() + o.count(), kernels::unite); }
+    [[nodiscard]] sparse_set operator -(sparse_set const& o) const
+        { return combine(o, count(), kernels::difference); }
+    [[nodiscard]] sparse_set operator ^(sparse_set const& o) const
+        { return combine(o, count() + o.count(), kernels::symmetric_difference); }
+
+    sparse_set& operator |=(sparse_set const& o) { return *this = *this | o; }
+    sparse_set& operator &=(sparse_set const& o) { return *this = *this & o; }
+    sparse_set& operator -=(sparse_set const& o) { return *this = *this - o; }
+    sparse_set& operator ^=(sparse_set const& o) { return *this = *this ^ o; }
+    /// --- end set algebra ---
+
+    /// --- mixed sparse and dense operations ---
+    // Each costs one bit probe per sparse member and never scans the span.
+    [[nodiscard]] size_t count_intersection(const_span dense) const {
+        ensure_same_universe(dense);
+        size_t total = 0;
+        for (I e : _elems) total += dense[e];
+        return total;
+    }
+    [[nodiscard]] bool intersects(const_span dense) const {
+        ensure_same_universe(dense);
+        return std::any_of(_elems.begin(), _elems.end(), [&](I e) { return dense[e]; });
+    }
+    [[nodiscard]] bool is_subset_of(const_span dense) const {
+        ensure_same_universe(dense);
+        return std::all_of(_elems.begin(), _elems.end(), [&](I e) { return dense[e]; });
+    }
+    /// Members that are also set in dense.
+    sparse_set& operator &=(const_span dense) {
+        ensure_same_universe(dense);
+        std::erase_if(_elems, [&](I e) { return !dense[e]; });
+        return *this;
+    }
+    /// Members that are not set in dense.
+    sparse_set& operator -=(const_span dense) {
+        ensure_same_universe(dense);
+        std::erase_if(_elems, [&](I e) { return dense[e]; });
+        return *this;
+    }
+    /// Sets (or with val = false, clears) every member's bit in dense.
+    void scatter_into(mut_span dense, bool val = true) const {
+        if (_universe != dense.len()) throw bitspan_length_mismatch();
+        for (I e : _elems) dense[e] = val;
+    }
+    [[nodiscard]] bitvec<W> to_bitvec() const {
+        bitvec<W> rslt(_universe);
+        scatter_into(rslt.span());
+        return rslt;
+    }
+    /// --- end mixed sparse and dense operations ---
+};
+
+template<bitspan_word W, std::unsigned_integral I>
+std::ostream& operator<<(std::ostream& o, sparse_set<W, I> const& s) {
+    o << '{';
+    for (size_t k = 0; k < s.elements().size(); k++) o << (k ? ", " : "") << s.elements()[k];
+    return o << '}';
+}
+
+/// --- explicit instantiation ---
+template struct sparse_set<>;
+/// --- end explicit instantiation ---
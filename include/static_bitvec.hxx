@@ -0,0 +1,158 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include "bitspan.hxx"
+#include "forward.hxx"
+
+/// Fixed-length bit vector of N bits held inline in a std::array.  Bits past
+/// N in the last word are kept at zero, so whole-word comparisons and counts
+/// need no residual masking and the one mask that is needed is a constant.
+template<size_t N, bitspan_word W> requires (!std::is_const_v<W>)
+struct static_bitvec final {
+public:
+    // --- type associations ---
+    using word       = W;
+    using const_span = bitspan<W const, N>;
+    using mut_span   = bitspan<W,       N>;
+    // --- end type associations ---
+
+    // --- constants ---
+    static constexpr size_t bits_per_word = const_span::bits_per_word;
+    static constexpr size_t majshift      = const_span::majshift;
+    static constexpr size_t minmask       = const_span::minmask;
+    static constexpr size_t word_count    = const_span::static_word_count;
+    static constexpr W      residual_mask = (N & minmask) == 0
+                                          ? W(~W(0)) : W((W(1) << (N & minmask)) - 1);
+    // --- end constants ---
+
+private:
+    // --- fields ---
+    std::array<W, word_count> _words {};
+    // --- end fields ---
+
+    template<typename F>
+    static constexpr void for_each_word(F f) { const_span::_for_each_static_word(f); }
+    constexpr void clear_residual() noexcept {
+        if constexpr ((N & minmask) != 0) _words[word_count - 1] &= residual_mask;
+    }
+    static constexpr void ensure_idx(size_t i)
+        { if (i >= N) throw std::out_of_range("static_bitvec index out of range"); }
+
+public:
+    // --- constructors ---
+    constexpr static_bitvec() noexcept = default;
+    // --- end constructors ---
+
+    // --- accessors ---
+    [[nodiscard]] static constexpr size_t len() noexcept { return N; }
+    [[nodiscard]] constexpr std::span<W const, word_count> words() const noexcept { return _words; }
+    [[nodiscard]] constexpr std::span<W,       word_count> words()       noexcept { return _words; }
+    // --- end accessors ---
+
+    // --- span acquisition ---
+    [[nodiscard]] constexpr operator bitspan<W const>() const & noexcept
+        { return bitspan<W const>(_words.data(), N); }
+    [[nodiscard]] constexpr operator bitspan<W      >()       & noexcept
+        { return bitspan<W      >(_words.data(), N); }
+    [[nodiscard]] operator bitspan<W const>() && = delete;
+    [[nodiscard]] operator bitspan<W      >() && = delete;
+
+    [[nodiscard]] constexpr operator const_span() const & noexcept
+        { return const_span(_words.data()); }
+    [[nodiscard]] constexpr operator mut_span  ()       & noexcept
+        { return mut_span  (_words.data()); }
+    [[nodiscard]] operator const_span() && = delete;
+    [[nodiscard]] operator mut_span  () && = delete;
+
+    [[nodiscard]] constexpr const_span span() const & noexcept { return *this; }
+    [[nodiscard]] constexpr mut_span   span()       & noexcept { return *this; }
+    [[nodiscard]] mut_span span() && = delete;
+    // --- end span acquisition ---
+
+    /// --- indexing ---
+    [[nodiscard]] constexpr bool test(size_t i) const
+        { ensure_idx(i); return (_words[i >> majshift] >> (i & minmask)) & 1; }
+    constexpr static_bitvec& set(size_t i, bool val = true) {
+        ensure_idx(i);
+        W& w = _words[i >> majshift];
+        w = (w & ~(W(1) << (i & minmask))) | (W(val) << (i & minmask));
+        return *this;
+    }
+    [[nodiscard]] constexpr bool       operator[](size_t i) const { return test(i); }
+    [[nodiscard]]           bit_ref<W> operator[](size_t i)       { return span()[i]; }
+    /// --- end indexing ---
+
+    /// --- bulk bitwise operations ---
+    [[nodiscard]] constexpr bool operator==(static_bitvec const& o) const noexcept
+        { return _words == o._words; }
+
+    constexpr static_bitvec& reset(bool val = false) noexcept {
+        for_each_word([&](size_t i) { _words[i] = W(0) - W(val); });
+        clear_residual();
+        return *this;
+    }
+    constexpr static_bitvec& invert() noexcept {
+        for_each_word([&](size_t i) { _words[i] = ~_words[i]; });
+        clear_residual();
+        return *this;
+    }
+    constexpr static_bitvec& operator &=(static_bitvec const& o) noexcept
+        { for_each_word([&](size_t i) { _words[i] &= o._words[i]; }); return *this; }
+    constexpr static_bitvec& operator |=(static_bitvec const& o) noexcept
+        { for_each_word([&](size_t i) { _words[i] |= o._words[i]; }); return *this; }
+    constexpr static_bitvec& operator ^=(static_bitvec const& o) noexcept
+        { for_each_word([&](size_t i) { _words[i] ^= o._words[i]; }); return *this; }
+    constexpr static_bitvec& and_not    (static_bitvec const& o) noexcept
+        { for_each_word([&](size_t i) { _words[i] &= ~o._words[i]; }); return *this; }
+
+    // Runtime-length operands go through the generic bitspan kernels, which
+    // leave the bits past an operand's length untouched or zeroed
+    static_bitvec& operator &=(bitspan<W const> o) { span() &= o;        return *this; }
+    static_bitvec& operator |=(bitspan<W const> o) { span() |= o;        return *this; }
+    static_bitvec& operator ^=(bitspan<W const> o) { span() ^= o;        return *this; }
+    static_bitvec& and_not    (bitspan<W const> o) { span().and_not(o);  return *this; }
+    static_bitvec& set_from   (bitspan<W const> o) { span().set_from(o); return *this; }
+
+    [[nodiscard]] constexpr static_bitvec operator ~() const noexcept
+        { auto rslt = *this; rslt.invert(); return rslt; }
+    [[nodiscard]] constexpr static_bitvec operator &(static_bitvec const& o) const noexcept
+        { auto rslt = *this; rslt &= o; return rslt; }
+    [[nodiscard]] constexpr static_bitvec operator |(static_bitvec const& o) const noexcept
+        { auto rslt = *this; rslt |= o; return rslt; }
+    [[nodiscard]] constexpr static_bitvec operator ^(static_bitvec const& o) const noexcept
+        { auto rslt = *this; rslt ^= o; return rslt; }
+    /// --- end bulk bitwise operations ---
+
+    /// --- set predicates and counting ---
+    [[nodiscard]] constexpr size_t count() const noexcept {
+        size_t total = 0;
+        for_each_word([&](size_t i) { total += std::popcount(_words[i]); });
+        return total;
+    }
+    [[nodiscard]] constexpr bool any() const noexcept {
+        W acc = 0;
+        for_each_word([&](size_t i) { acc |= _words[i]; });
+        return acc != 0;
+    }
+    [[nodiscard]] constexpr bool none() const noexcept { return !any(); }
+    [[nodiscard]] constexpr bool intersects(static_bitvec const& o) const noexcept
+        { return (*this & o).any(); }
+    [[nodiscard]] constexpr bool is_subset_of(static_bitvec const& o) const noexcept
+        { auto rslt = *this; return rslt.and_not(o).none(); }
+    [[nodiscard]] constexpr bool is_superset_of(static_bitvec const& o) const noexcept
+        { return o.is_subset_of(*this); }
+    [[nodiscard]] constexpr bool is_disjoint(static_bitvec const& o) const noexcept
+        { return !intersects(o); }
+    /// --- end set predicates and counting ---
+};
+
+template<size_t N, bitspan_word W>
+std::ostream& operator<<(std::ostream& o, static_bitvec<N, W> const& b) { return o << b.span(); }
+
+/// --- explicit instantiation ---
+template struct static_bitvec<64>;
+template struct static_bitvec<100>;
+/// --- end explicit instantiation ---
@@ -0,0 +1,150 @@
+#pragma once
+#include <bit>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+#include "bitspan.hxx"
+#include "bitvec.hxx"
+#include "forward.hxx"
+
+/// Bit vector with a tree of summary levels above it.  Bit j of level k + 1
+/// is set iff word j of level k is nonzero, so each level is bits_per_word
+/// times shorter (64-ary for 64-bit words) and the top level is one word.
+/// Searches climb to the first level with a nonzero word in range and then
+/// descend with one countr_zero per level, which takes O(log n) word reads
+/// however far apart the set bits are.
+template<bitspan_word W> requires (!std::is_const_v<W>)
+struct summary_bitvec final {
+public:
+    // --- type associations ---
+    using word       = W;
+    using const_span = bitspan<W const>;
+    // --- end type associations ---
+
+    // --- constants ---
+    static constexpr size_t bits_per_word = const_span::bits_per_word;
+    static constexpr size_t majshift      = const_span::majshift;
+    static constexpr size_t minmask       = const_span::minmask;
+    // --- end constants ---
+
+private:
+    // --- fields ---
+    std::vector<bitvec<W>> _levels; // _levels[0] holds the bits themselves
+    // --- end fields ---
+
+    [[nodiscard]] W word_at(size_t level, size_t i) const noexcept
+        { return _levels[level].words()[i]; }
+    [[nodiscard]] static size_t top_bit(W w) noexcept { return minmask - std::countl_zero(w); }
+    void ensure_idx(size_t i) const
+        { if (i >= len()) throw std::out_of_range("summary_bitvec index out of range"); }
+
+    /// Recomputes every summary level from the one below it.
+    void rebuild() {
+        for (size_t l = 1; l < _levels.size(); l++) {
+            auto& lower = _levels[l - 1];
+            _levels[l].reset();
+            for (size_t j = 0; j < lower.words().count(); j++)
+                if (lower.words()[j] != 0) _levels[l].words().of_bit(j) |= W(1) << (j & minmask);
+        }
+    }
+
+public:
+    // --- constructors ---
+    summary_bitvec() = default;
+    explicit summary_bitvec(size_t len) {
+        _levels.emplace_back(len);
+        while (_levels.back().len() > bits_per_word)
+            _levels.emplace_back(const_span::words_for_bitcount(_levels.back().len()));
+    }
+    explicit summary_bitvec(const_span o) : summary_bitvec(o.len()) { assign(o); }
+    // --- end constructors ---
+
+    // --- accessors ---
+    [[nodiscard]] size_t len()         const noexcept { return _levels.empty() ? 0 : _levels[0].len(); }
+    [[nodiscard]] size_t level_count() const noexcept { return _levels.size(); }
+    /// The bits themselves, for read-only use with the bitspan operations.
+    [[nodiscard]] const_span bits() const noexcept
+        { return _levels.empty() ? const_span(nullptr, 0) : _levels[0].span(); }
+    // --- end accessors ---
+
+    /// --- indexing ---
+    [[nodiscard]] bool operator[](size_t i) const { ensure_idx(i); return _levels[0][i]; }
+    summary_bitvec& set(size_t i) {
+        ensure_idx(i);
+        // Climb only while the word being written was empty before
+        for (size_t l = 0; l < _levels.size(); l++, i >>= majshift) {
+            W& w = _levels[l].words().of_bit(i);
+            bool was_empty = w == 0;
+            w |= W(1) << (i & minmask);
+            if (!was_empty) break;
+        }
+        return *this;
+    }
+    summary_bitvec& reset(size_t i) {
+        ensure_idx(i);
+        // Climb only while the word being written becomes empty
+        for (size_t l = 0; l < _levels.size(); l++, i >>= majshift) {
+            W& w = _levels[l].words().of_bit(i);
+            w &= ~(W(1) << (i & minmask));
+            if (w != 0) break;
+        }
+        return *this;
+    }
+    summary_bitvec& assign(size_t i, bool val) { return val ? set(i) : reset(i); }
+    /// --- end indexing ---
+
+    /// --- bulk operations ---
+    summary_bitvec& assign(const_span o) {
+        if (o.len() != len()) throw bitspan_length_mismatch();
+        _levels[0].set_from(o);
+        _levels[0].span().clear_residual();
+        rebuild();
+        return *this;
+    }
+    summary_bitvec& clear() { for (auto& l : _levels) l.reset(); return *this; }
+    /// --- end bulk operations ---
+
+    /// --- search ---
+    /// Smallest set index >= i.
+    [[nodiscard]] std::optional<size_t> find_next(size_t i) const noexcept {
+        if (i >= len()) return std::nullopt;
+        size_t l = 0;
+        for (;;) {
+            W w = word_at(l, i >> majshift) & (W(~W(0)) << (i & minmask));
+            if (w != 0) { i = (i & ~minmask) + std::countr_zero(w); break; }
+            i = (i >> majshift) + 1;
+            if (++l == _levels.size() || i >= _levels[l].len()) return std::nullopt;
+        }
+        while (l-- > 0) i = (i << majshift) + std::countr_zero(word_at(l, i));
+        return i;
+    }
+    /// Largest set index <= i.
+    [[nodiscard]] std::optional<size_t> find_prev(size_t i) const noexcept {
+        if (len() == 0) return std::nullopt;
+        i = std::min(i, len() - 1);
+        size_t l = 0;
+        for (;;) {
+            W w = word_at(l, i >> majshift) & (W(~W(0)) >> (minmask - (i & minmask)));
+            if (w != 0) { i = (i & ~minmask) + top_bit(w); break; }
+            if ((i >> majshift) == 0) return std::nullopt;
+            i = (i >> majshift) - 1;
+            l++;
+        }
+        while (l-- > 0) i = (i << majshift) + top_bit(word_at(l, i));
+        return i;
+    }
+    [[nodiscard]] std::optional<size_t> min() const noexcept { return find_next(0); }
+    [[nodiscard]] std::optional<size_t> max() const noexcept { return find_prev(SIZE_MAX); }
+    [[nodiscard]] bool empty() const noexcept { return len() == 0 || word_at(_levels.size() - 1, 0) == 0; }
+    [[nodiscard]] bool any  () const noexcept { return !empty(); }
+    [[nodiscard]] size_t count() const noexcept { return bits().count(); }
+    /// --- end search ---
+};
+
+template<bitspan_word W>
+std::ostream& operator<<(std::ostream& o, summary_bitvec<W> const& b) { return o << b.bits(); }
+
+/// --- explicit instantiation ---
+template struct summary_bitvec<>;
+/// --- end explicit instantiation ---
@@ -0,0 +1,120 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include "bitspan_word.hxx"
+
+// --- word operations ---
+// Every op is a lane-agnostic bitwise function, so the 256-bit forms are
+// valid for any word width.
+struct word_op_and final {
+    template<bitspan_word W>
+    [[nodiscard]] static constexpr W apply(W a, W b) noexcept { return a & b; }
+#if defined(__AVX2__)
+    [[nodiscard]] static __m256i apply(__m256i a, __m256i b) noexcept
+        { return _mm256_and_si256(a, b); }
+#endif
+};
+struct word_op_or final {
+    template<bitspan_word W>
+    [[nodiscard]] static constexpr W apply(W a, W b) noexcept { return a | b; }
+#if defined(__AVX2__)
+    [[nodiscard]] static __m256i apply(__m256i a, __m256i b) noexcept
+        { return _mm256_or_si256(a, b); }
+#endif
+};
+struct word_op_xor final {
+    template<bitspan_word W>
+    [[nodiscard]] static constexpr W apply(W a, W b) noexcept { return a ^ b; }
+#if defined(__AVX2__)
+    [[nodiscard]] static __m256i apply(__m256i a, __m256i b) noexcept
+        { return _mm256_xor_si256(a, b); }
+#endif
+};
+/// a & ~b
+struct word_op_andnot final {
+    template<bitspan_word W>
+    [[nodiscard]] static constexpr W apply(W a, W b) noexcept { return a & W(~b); }
+#if defined(__AVX2__)
+    [[nodiscard]] static __m256i apply(__m256i a, __m256i b) noexcept
+        { return _mm256_andnot_si256(b, a); }
+#endif
+};
+// --- end word operations ---
+
+/// Fused loops over raw word arrays backing the bitspan bulk operations.
+/// Callers are responsible for residual masking; these only see whole words.
+template<bitspan_word W> requires (!std::is_const_v<W>)
+struct word_kernels final {
+    static constexpr size_t block_words = 8;
+#if defined(__AVX2__)
+    static constexpr size_t vec_words = sizeof(__m256i) / sizeof(W);
+    [[nodiscard]] static __m256i load(W const* p) noexcept
+        { return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)); }
+#endif
+
+    /// Whether Op(a[i], b[i]) is nonzero for any i < n.  Exits on the first
+    /// block containing a witness word.
+    template<typename Op>
+    [[nodiscard]] static bool any(W const* a, W const* b, size_t n) noexcept {
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 2 * vec_words <= n; i += 2 * vec_words) {
+            __m256i acc = _mm256_or_si256(Op::apply(load(a + i),             load(b + i)),
+                                          Op::apply(load(a + i + vec_words), load(b + i + vec_words)));
+            if (!_mm256_testz_si256(acc, acc)) return true;
+        }
+#endif
+        // Accumulating a block before testing keeps the loop branch-light
+        // and lets the compiler vectorize it where AVX2 isn't available
+        for (; i + block_words <= n; i += block_words) {
+            W acc = 0;
+            for (size_t j = 0; j < block_words; j++) acc |= Op::apply(a[i + j], b[i + j]);
+            if (acc != 0) return true;
+        }
+        for (; i < n; i++) if (Op::apply(a[i], b[i]) != 0) return true;
+        return false;
+    }
+
+    /// Whether a[i] is nonzero for any i < n.
+    [[nodiscard]] static bool any(W const* a, size_t n) noexcept
+        { return any<word_op_or>(a, a, n); }
+
+#if defined(__AVX2__)
+    /// Per-64-bit-lane popcount using a nibble lookup table (Mula et al.)
+    [[nodiscard]] static __m256i popcount_lanes(__m256i v) noexcept {
+        const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i low = _mm256_set1_epi8(0x0f);
+        __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low));
+        __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+        return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+    }
+    [[nodiscard]] static size_t hsum_lanes(__m256i v) noexcept {
+        __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        return _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1);
+    }
+#endif
+
+    /// Total number of set bits in Op(a[i], b[i]) over i < n.
+    template<typename Op>
+    [[nodiscard]] static size_t count(W const* a, W const* b, size_t n) noexcept {
+        size_t i = 0, total = 0;
+#if defined(__AVX2__)
+        __m256i acc = _mm256_setzero_si256();
+        for (; i + vec_words <= n; i += vec_words)
+            acc = _mm256_add_epi64(acc, popcount_lanes(Op::apply(load(a + i), load(b + i))));
+        total = hsum_lanes(acc);
+#endif
+        for (; i < n; i++) total += std::popcount(Op::apply(a[i], b[i]));
+        return total;
+    }
+
+    /// Total number of set bits in a[i] over i < n.
+    [[nodiscard]] static size_t count(W const* a, size_t n) noexcept
+        { return count<word_op_or>(a, a, n); }
+};
@@ -0,0 +1,101 @@
+// Segmented, multithreaded Sieve of Eratosthenes over odd numbers.
+//
+// usage: finitesets-sieve [limit] [threads] [segment KiB]
+//
+// Bit k of a segment starting at odd number `lo` stands for lo + 2k.  Each
+// segment is sized to stay resident in L1/L2 while every base prime strides
+// over it, and worker threads pull segments off a shared counter.
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "bitvec.hxx"
+
+using word = default_bitspan_word;
+
+/// Counts zero bits, i.e. numbers that survived the sieve.
+static size_t count_unmarked(bitspan<word const> s) {
+    size_t marked = 0;
+    for (word w : s.words()) marked += std::popcount(w);
+    return s.len() - marked;
+}
+
+/// Odd primes p with p * p <= limit, found with a plain odd-only sieve.
+static std::vector<size_t> base_primes(size_t limit) {
+    size_t root = std::sqrt(static_cast<double>(limit));
+    while (root * root > limit) root--;
+    while ((root + 1) * (root + 1) <= limit) root++;
+
+    bitvec<word> composite((root + 1) / 2); // bit k is 2k + 1
+    auto s = composite.span();
+    std::vector<size_t> primes;
+    for (size_t k = 1; k < s.len(); k++) {
+        if (s[k]) continue;
+        size_t p = 2 * k + 1;
+        primes.push_back(p);
+        for (size_t j = (p * p) / 2; j < s.len(); j += p) s[j] |= true;
+    }
+    return primes;
+}
+
+/// Sieves the odd numbers in [lo, lo + 2 * bits) and returns how many are prime.
+static size_t sieve_segment(bitvec<word>& seg, size_t lo, size_t bits,
+                            std::vector<size_t> const& primes) {
+    seg.resize(bits);
+    seg.reset();
+    auto s = seg.span();
+    const size_t hi = lo + 2 * bits;
+    for (size_t p : primes) {
+        if (p * p >= hi) break;
+        size_t start = std::max(p * p, (lo + p - 1) / p * p);
+        if (start % 2 == 0) start += p;
+        for (size_t j = (start - lo) / 2; j < bits; j += p) s[j] |= true;
+    }
+    if (lo == 1) s[0] |= true; // 1 is not prime
+    return count_unmarked(s);
+}
+
+int main(int argc, char** argv) {
+    const size_t limit   = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1'000'000'000;
+    const size_t threads = (argc > 2) ? std::strtoull(argv[2], nullptr, 10)
+                                      : std::max(1U, std::thread::hardware_concurrency());
+    const size_t seg_kib = (argc > 3) ? std::strtoull(argv[3], nullptr, 10) : 32;
+    if (limit < 2 || threads == 0 || seg_kib == 0) {
+        std::cerr << "usage: " << argv[0] << " [limit >= 2] [threads] [segment KiB]\n";
+        return 1;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const auto primes = base_primes(limit);
+    const size_t seg_bits = seg_kib * 1024 * 8;
+    const size_t odd_count = (limit + 1) / 2; // odd numbers 1, 3, ..., <= limit
+    const size_t seg_count = (odd_count + seg_bits - 1) / seg_bits;
+
+    std::atomic<size_t> next_seg {0}, total {1}; // 2 is prime
+    auto worker = [&] {
+        bitvec<word> seg(seg_bits);
+        size_t found = 0;
+        for (size_t i; (i = next_seg.fetch_add(1, std::memory_order_relaxed)) < seg_count;) {
+            size_t first = i * seg_bits;
+            size_t bits  = std::min(seg_bits, odd_count - first);
+            found += sieve_segment(seg, 2 * first + 1, bits, primes);
+        }
+        total.fetch_add(found, std::memory_order_relaxed);
+    };
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; t++) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - t0;
+
+    std::cout << "primes <= " << limit << ": " << total << '\n'
+              << "threads: " << threads << ", segment: " << seg_kib << " KiB\n"
+              << "time: " << elapsed.count() << " s\n"
+              << "rate: " << static_cast<double>(total) / elapsed.count() << " primes/s, "
+              << static_cast<double>(limit) / elapsed.count() << " numbers/s\n";
+}
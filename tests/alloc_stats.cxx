@@ -0,0 +1,100 @@
+#include "bitvec.hxx"
+#include <gtest.h>
+
+// NOLINTBEGIN
+TEST(alloc_stats, disabled_tracker_takes_no_space) {
+    static_assert(sizeof(alloc_tracker<false>) == 1);
+    if (!alloc_stats::enabled) { EXPECT_EQ(3 * sizeof(void*), sizeof(bitvec<>)); }
+}
+
+TEST(alloc_stats, counts_instance_allocations_and_slack) {
+    alloc_tracker<true> t;
+    t.on_allocate(0, 128);
+    t.on_resize(0, 100);
+    auto s = t.snapshot();
+    EXPECT_EQ(1, s.mallocs);
+    EXPECT_EQ(16, s.bytes_allocated);
+    EXPECT_EQ(100, s.len_bits);
+    EXPECT_EQ(128, s.cap_bits);
+    EXPECT_EQ(28, s.slack_bits());
+    EXPECT_EQ(16, s.live_bytes);
+
+    t.on_allocate(128, 1024);
+    t.on_copy(40);
+    EXPECT_EQ(1, t.snapshot().reallocs);
+    EXPECT_EQ(16 + 128, t.snapshot().bytes_allocated);
+    EXPECT_EQ(40, t.snapshot().bytes_copied);
+    t.reset();
+    EXPECT_EQ(0, t.snapshot().reallocs);
+    EXPECT_EQ(0, t.snapshot().bytes_copied);
+    EXPECT_EQ(100, t.snapshot().len_bits);
+    EXPECT_EQ(128, t.snapshot().live_bytes);
+
+    t.on_resize(100, 0);
+    t.on_allocate(1024, 0);
+    EXPECT_EQ(1, t.snapshot().frees);
+    EXPECT_EQ(0, t.snapshot().live_bytes);
+    EXPECT_EQ(0, t.snapshot().slack_bits());
+}
+
+TEST(alloc_stats, trackers_mirror_into_process_totals) {
+    auto before = alloc_stats::snapshot();
+    {
+        alloc_tracker<true> a, b;
+        a.on_allocate(0, 512);  a.on_resize(0, 500);
+        b.on_allocate(0, 64);   b.on_resize(0, 10);
+        b.on_allocate(64, 512); b.on_copy(64);
+        auto during = alloc_stats::snapshot();
+        EXPECT_EQ(before.mallocs + 2, during.mallocs);
+        EXPECT_EQ(before.reallocs + 1, during.reallocs);
+        EXPECT_EQ(before.bytes_allocated + 64 + 8 + 64, during.bytes_allocated);
+        EXPECT_EQ(before.bytes_copied + 64, during.bytes_copied);
+        EXPECT_EQ(before.live_bytes + 128, during.live_bytes);
+        EXPECT_EQ(before.len_bits + 510, during.len_bits);
+        EXPECT_EQ(before.cap_bits + 1024, during.cap_bits);
+        a.on_resize(500, 0); a.on_allocate(512, 0);
+        b.on_resize(10, 0);  b.on_allocate(512, 0);
+    }
+    auto after = alloc_stats::snapshot();
+    EXPECT_EQ(before.frees + 2, after.frees);
+    EXPECT_EQ(before.live_bytes, after.live_bytes);
+    EXPECT_EQ(before.len_bits, after.len_bits);
+    EXPECT_EQ(before.cap_bits, after.cap_bits);
+
+    alloc_stats::reset();
+    EXPECT_EQ(0, alloc_stats::snapshot().mallocs);
+    EXPECT_EQ(before.live_bytes, alloc_stats::snapshot().live_bytes);
+}
+
+TEST(alloc_stats, bitvecs_report_their_allocations) {
+    if (!alloc_stats::enabled) return;
+    alloc_stats::reset();
+    auto before = alloc_stats::snapshot();
+    {
+        bitvec<> a(1000), b(10);
+        b = a;
+        auto during = alloc_stats::snapshot();
+        EXPECT_EQ(2, during.mallocs);
+        EXPECT_EQ(1, during.reallocs);
+        EXPECT_EQ(a.words().count() * sizeof(uintptr_t), during.bytes_copied);
+        EXPECT_EQ(before.len_bits + 2000, during.len_bits);
+        EXPECT_EQ(before.live_bytes + (a.cap() + b.cap()) / 8, during.live_bytes);
+
+        bitvec<> c(std::move(a));
+        EXPECT_EQ(during.live_bytes, alloc_stats::snapshot().live_bytes);
+        EXPECT_EQ(1000, c.memory_stats().len_bits);
+        EXPECT_EQ(1, c.memory_stats().mallocs);
+        EXPECT_EQ(c.cap() - c.len(), c.memory_stats().slack_bits());
+        c.resize(100000);
+        EXPECT_EQ(1, c.memory_stats().reallocs);
+        c.reset_memory_stats();
+        EXPECT_EQ(0, c.memory_stats().reallocs);
+        EXPECT_EQ(100000, c.memory_stats().len_bits);
+    }
+    auto after = alloc_stats::snapshot();
+    EXPECT_EQ(2, after.frees);
+    EXPECT_EQ(before.live_bytes, after.live_bytes);
+    EXPECT_EQ(before.len_bits, after.len_bits);
+    EXPECT_EQ(before.cap_bits, after.cap_bits);
+}
+// NOLINTEND
@@ -0,0 +1,68 @@
+#include "bit_transpose.hxx"
+#include "bitvec.hxx"
+#include <gtest.h>
+#include <random>
+#include <vector>
+
+// NOLINTBEGIN
+template<typename W>
+static void check_square_block() {
+    std::mt19937_64 rng(42);
+    bit_block<W> a, t;
+    for (auto& w : a) w = W(rng());
+    t = a;
+    transpose_block<W>(t);
+    for (size_t r = 0; r < a.size(); r++)
+        for (size_t c = 0; c < a.size(); c++)
+            ASSERT_EQ((a[r] >> c) & 1, (t[c] >> r) & 1);
+    transpose_block<W>(t);
+    EXPECT_EQ(a, t);
+}
+
+TEST(bit_transpose, transpose8x8_moves_bit_rc_to_cr) {
+    for (size_t r = 0; r < 8; r++)
+        for (size_t c = 0; c < 8; c++)
+            EXPECT_EQ(uint64_t(1) << (8 * c + r), transpose8x8(uint64_t(1) << (8 * r + c)));
+}
+
+TEST(bit_transpose, square_blocks_of_every_word_width) {
+    check_square_block<uint8_t>();
+    check_square_block<uint16_t>();
+    check_square_block<uint32_t>();
+    check_square_block<uint64_t>();
+}
+
+TEST(bit_transpose, transpose_block_is_constexpr) {
+    constexpr auto t = [] {
+        bit_block<uint16_t> a {};
+        a[3] = 1 << 5;
+        transpose_block<uint16_t>(a);
+        return a;
+    }();
+    static_assert(t[5] == 1 << 3);
+}
+
+TEST(bit_transpose, transpose_non_square_matrix) {
+    const size_t m = 70, n = 131;
+    std::mt19937_64 rng(7);
+    std::vector<bitvec<>> rows(m, bitvec<>(n)), cols(n, bitvec<>(m));
+    for (size_t r = 0; r < m; r++)
+        for (size_t c = 0; c < n; c++) rows[r][c] = (rng() & 3) == 0;
+
+    std::vector<bitspan<const uintptr_t>> src;
+    std::vector<bitspan<uintptr_t>> dst;
+    for (auto& r : rows) src.push_back(r.span());
+    for (auto& c : cols) dst.push_back(c.span());
+    transpose(src, dst);
+
+    for (size_t r = 0; r < m; r++)
+        for (size_t c = 0; c < n; c++) ASSERT_EQ(rows[r][c], cols[c][r]);
+}
+
+TEST(bit_transpose, throws_on_ragged_rows) {
+    bitvec<> a(10), b(11), c(2);
+    std::vector<bitspan<const uintptr_t>> src { a.span(), b.span() };
+    std::vector<bitspan<uintptr_t>> dst(10, c.span());
+    ASSERT_ANY_THROW(transpose(src, dst));
+}
+// NOLINTEND
@@ -0,0 +1,87 @@
+#include "bitspan.hxx"
+#include "bitvec.hxx"
+#include <array>
+#include <cstdint>
+#include <gtest.h>
+
+// NOLINTBEGIN
+static_assert(sizeof(bitspan<uint64_t, 100>) == sizeof(uint64_t*));
+static_assert(bitspan<uint64_t, 100>::static_word_count == 2);
+static_assert(bitspan<uint8_t, 100>::static_word_count == 13);
+static_assert(std::is_convertible_v<bitspan<uint64_t, std::dynamic_extent, index_unchecked>,
+                                    bitspan<uint64_t const>>);
+static_assert(!std::is_convertible_v<bitspan<uint64_t>,
+                                     bitspan<uint64_t, std::dynamic_extent, index_unchecked>>);
+
+TEST(bitspan, static_extent_from_array) {
+    std::array<uint64_t, 2> words {~uint64_t(0), ~uint64_t(0)};
+    bitspan<uint64_t, 100> s(words);
+    EXPECT_EQ(100, s.len());
+    EXPECT_EQ(100, s.count());
+    bitspan<uint64_t const> d = s;
+    EXPECT_EQ(100, d.len());
+    EXPECT_EQ(100, s.dynamic().count());
+}
+
+TEST(bitspan, static_extent_from_dynamic_checks_length) {
+    bitvec<uint64_t> v(100), w(99);
+    bitspan<uint64_t, 100> s(v.span());
+    s[3] = true;
+    EXPECT_TRUE(v[3]);
+    ASSERT_ANY_THROW((bitspan<uint64_t, 100>(w.span())));
+}
+
+TEST(bitspan, static_extent_ops_match_dynamic) {
+    std::array<uint8_t, 13> a {}, b {}, c {};
+    for (size_t i = 0; i < a.size(); i++) {
+        a[i] = uint8_t(i * 37 + 11);
+        b[i] = uint8_t(i * 91 + 5);
+    }
+    bitspan<uint8_t, 100> sa(a), sb(b), sc(c);
+    bitvec<uint8_t> va(100), vb(100);
+    va.set_from(sa);
+    vb.set_from(sb);
+
+    bitvec<uint8_t> vand = va & vb, vor = va | vb, vxor = va ^ vb;
+    sc.set_from(sa) &= sb;
+    EXPECT_TRUE(sc.dynamic() == vand.span());
+    sc.set_from(sa) |= sb;
+    EXPECT_TRUE(sc.dynamic() == vor.span());
+    sc.set_from(sa) ^= sb;
+    EXPECT_TRUE(sc.dynamic() == vxor.span());
+    sc.set_from(sa).and_not(sb);
+    EXPECT_EQ(va.count_andnot(vb), sc.count());
+}
+
+TEST(bitspan, static_extent_equality_ignores_residual) {
+    std::array<uint64_t, 2> a {5, 1}, b {5, 1 | (uint64_t(1) << 50)};
+    bitspan<uint64_t const, 100> sa(a), sb(b);
+    EXPECT_TRUE(sa == sb);
+    b[0] = 4;
+    EXPECT_FALSE(sa == sb);
+}
+TEST(bitspan, checked_indexing_rejects_the_length_itself) {
+    std::array<uint64_t, 2> words {};
+    bitspan<uint64_t> s(words);
+    bitspan<uint64_t const, 100> st(words);
+    EXPECT_NO_THROW(s[127] = true);
+    EXPECT_THROW((void)s[128], std::out_of_range);
+    EXPECT_THROW((void)st[100], std::out_of_range);
+    EXPECT_NO_THROW((void)st[99]);
+}
+
+TEST(bitspan, unchecked_policy_and_accessors_skip_the_check) {
+    std::array<uint64_t, 2> words {};
+    bitspan<uint64_t> s(words);
+    auto u = s.with_check<index_unchecked>();
+    static_assert(std::is_same_v<decltype(u)::check, index_unchecked>);
+    u[3] = true;
+    u.set_unchecked(70).set_unchecked(71).set_unchecked(71, false);
+    EXPECT_TRUE(s[3] && s[70] && !s[71]);
+    EXPECT_TRUE(s.test_unchecked(70));
+    bitspan<uint64_t const> back = u;
+    EXPECT_EQ(2, back.count());
+    auto a = s.with_check<index_asserted>();
+    EXPECT_TRUE(a[3]);
+}
+// NOLINTEND
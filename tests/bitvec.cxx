@@ -1,5 +1,7 @@
 #include "bitvec.hxx"
+#include <array>
 #include <gtest.h>
+#include <random>
 
 // NOLINTBEGIN
 TEST(bitvec, create_with_positive_length)
@@ -164,6 +166,28 @@ TEST(bitvec, and_operator_applied_to_bitfields_of_non_equal_size) {
     EXPECT_EQ(expbv, bv1 & bv2);
 }
 
+TEST(bitvec, and_operator_zero_extends_operand_shorter_by_several_words) {
+    bitvec<> bv1(300), bv2(64);
+    for (size_t i = 0; i < bv1.len(); i++) bv1[i] = true;
+    bv2[3] = true;
+    bv2[63] = true;
+
+    bitvec<> expbv(300);
+    expbv[3] = true;
+    expbv[63] = true;
+
+    EXPECT_EQ(expbv, bv1 & bv2);
+}
+
+TEST(bitvec, and_not_clears_bits_set_in_operand) {
+    bitvec<> bv1(100), bv2(70), expbv(100);
+    bv1[1] = bv1[69] = bv1[99] = true;
+    bv2[1] = bv2[69] = true;
+    expbv[99] = true;
+    bv1.and_not(bv2);
+    EXPECT_EQ(expbv, bv1);
+}
+
 TEST(bitvec, can_invert_bitfield) {
     const unsigned size = 2;
     bitvec<> bv(size), negbv(size), expNegbv(size);
@@ -224,4 +248,206 @@ TEST(bitvec, bitfields_with_different_bits_are_not_equal) {
 
     EXPECT_NE(bv1, bv2);
 }
+
+static bitvec<> random_bitvec(std::mt19937_64& rng, size_t len, unsigned one_in) {
+    bitvec<> bv(len);
+    for (size_t i = 0; i < len; i++) bv[i] = rng() % one_in == 0;
+    return bv;
+}
+
+TEST(bitvec, set_predicates_match_bitwise_definitions) {
+    std::mt19937_64 rng(1);
+    const size_t lens[] = {1, 63, 64, 65, 200, 640, 1111};
+    for (size_t la : lens) for (size_t lb : lens) for (unsigned one_in : {2, 50, 5000}) {
+        auto a = random_bitvec(rng, la, one_in);
+        auto b = random_bitvec(rng, lb, one_in);
+        // Make subsets likely: a becomes a & b half of the time
+        if (rng() & 1) { a.resize(std::max(la, lb)); a &= b; a.resize(la); }
+        bool inter = false, sub = true, sup = true, eq = true;
+        for (size_t i = 0; i < std::max(la, lb); i++) {
+            bool x = i < la && a[i], y = i < lb && b[i];
+            inter |= x && y; sub &= !x || y; sup &= x || !y; eq &= x == y;
+        }
+        EXPECT_EQ(inter, a.intersects(b));
+        EXPECT_EQ(!inter, a.is_disjoint(b));
+        EXPECT_EQ(sub, a.is_subset_of(b));
+        EXPECT_EQ(sup, a.is_superset_of(b));
+        EXPECT_EQ(eq, a.equals_ignoring_length(b));
+    }
+}
+
+TEST(bitvec, fused_counts_match_materialized_results) {
+    std::mt19937_64 rng(2);
+    const size_t lens[] = {0, 5, 64, 130, 1000, 4099};
+    for (size_t la : lens) for (size_t lb : lens) {
+        auto a = random_bitvec(rng, la, 3);
+        auto b = random_bitvec(rng, lb, 3);
+        size_t n_and = 0, n_or = 0, n_andnot = 0, n_xor = 0, n_a = 0;
+        for (size_t i = 0; i < std::max(la, lb); i++) {
+            bool x = i < la && a[i], y = i < lb && b[i];
+            n_a += x; n_and += x && y; n_or += x || y; n_andnot += x && !y; n_xor += x != y;
+        }
+        EXPECT_EQ(n_a, a.count());
+        EXPECT_EQ(n_and, a.count_and(b));
+        EXPECT_EQ(n_or, a.count_or(b));
+        EXPECT_EQ(n_andnot, a.count_andnot(b));
+        EXPECT_EQ(n_xor, a.count_xor(b));
+        EXPECT_EQ(n_a == 0, a.none());
+    }
+}
+
+TEST(bitvec, iter_visits_set_and_unset_bits_in_order) {
+    std::mt19937_64 rng(3);
+    for (size_t len : {0, 1, 63, 64, 65, 200}) {
+        auto bv = random_bitvec(rng, len, 3);
+        if (len != 0) bv[len - 1] = true;
+        std::vector<size_t> ones, zeros, got_ones, got_zeros;
+        for (size_t i = 0; i < len; i++) (bv[i] ? ones : zeros).push_back(i);
+        auto it1 = bv.iter<true>();
+        while (auto i = it1.next()) got_ones.push_back(*i);
+        auto it0 = bv.iter<false>();
+        while (auto i = it0.next()) got_zeros.push_back(*i);
+        EXPECT_EQ(ones, got_ones);
+        EXPECT_EQ(zeros, got_zeros);
+    }
+}
+
+TEST(bitvec, set_predicates_ignore_bits_past_length) {
+    bitvec<> a(70), b(70);
+    a.invert(); // sets the unused high bits of the last word as well
+    b.invert();
+    b[69] = false;
+    EXPECT_FALSE(a.is_subset_of(b));
+    b[69] = true;
+    a.truncate(3); b.truncate(3);
+    EXPECT_TRUE(a.is_subset_of(b));
+    EXPECT_TRUE(a.equals_ignoring_length(b));
+    EXPECT_EQ(3, a.count());
+    EXPECT_EQ(0, a.count_xor(b));
+    size_t visited = 0;
+    for (auto it = a.iter<true>(); it.next();) visited++;
+    EXPECT_EQ(3, visited);
+}
+
+TEST(bitvec, resize_keeps_whole_last_word_and_zeroes_exposed_bits) {
+    bitvec<> a(128);
+    a.invert();
+    a.resize(128);
+    EXPECT_EQ(128, a.count());
+    a.truncate(70);
+    a.resize(128);
+    EXPECT_EQ(70, a.count());
+    EXPECT_FALSE(a[100]);
+}
+TEST(bitvec, batched_scatters_match_single_bit_updates) {
+    const size_t len = 200000;
+    std::mt19937_64 rng(11);
+    std::vector<uint32_t> idx(5000);
+    for (auto& i : idx) i = uint32_t(rng() % len);
+    std::span<uint32_t> batch(idx);
+    for (auto order : {scatter_order::given, scatter_order::by_line, scatter_order::by_page}) {
+        bitvec<> expect(len), got(len);
+        for (auto i : idx) expect[i] = true;
+        got.set_many(batch, order);
+        EXPECT_EQ(expect, got);
+        for (size_t k = 0; k < idx.size(); k += 2) expect[idx[k]] = false;
+        std::vector<uint32_t> evens;
+        for (size_t k = 0; k < idx.size(); k += 2) evens.push_back(idx[k]);
+        got.reset_many(evens, order);
+        EXPECT_EQ(expect, got);
+        for (auto i : idx) expect[i] ^= true;
+        got.flip_many(batch, order);
+        EXPECT_EQ(expect, got);
+    }
+}
+
+TEST(bitvec, batched_scatter_validates_whole_batch_first) {
+    bitvec<uint8_t> a(100);
+    std::vector<size_t> idx {3, 50, 100};
+    EXPECT_THROW(a.set_many(idx), std::out_of_range);
+    EXPECT_TRUE(a.none());
+    idx.pop_back();
+    a.set_many(std::span(idx), scatter_order::by_page);
+    a.flip_many(std::array<uint16_t, 2>{7, 7});
+    EXPECT_EQ(2, a.count());
+    EXPECT_TRUE(a[3] && a[50]);
+}
+TEST(bitvec, batched_tests_match_single_bit_reads) {
+    const size_t len = 100000;
+    std::mt19937_64 rng(12);
+    bitvec<> a(len);
+    for (size_t i = 0; i < len / 3; i++) a[rng() % len] = true;
+    for (size_t n : {0, 5, 8, 67, 1000}) {
+        std::vector<uint32_t> idx32(n);
+        std::vector<uint64_t> idx64(n);
+        for (size_t k = 0; k < n; k++) idx64[k] = idx32[k] = uint32_t(rng() % len);
+        auto packed = a.test_many(idx32);
+        auto packed64 = a.test_many(std::span(idx64));
+        std::vector<uint8_t> bytes(n, 7);
+        a.test_many(idx32, bytes);
+        ASSERT_EQ(n, packed.len());
+        EXPECT_EQ(packed, packed64);
+        for (size_t k = 0; k < n; k++) {
+            EXPECT_EQ(a[idx32[k]], packed[k]);
+            EXPECT_EQ(uint8_t(a[idx32[k]]), bytes[k]);
+        }
+    }
+}
+
+TEST(bitvec, batched_tests_check_indices_and_output_length) {
+    bitvec<uint8_t> a(20);
+    a[19] = true;
+    std::vector<uint32_t> idx {19, 0, 20};
+    EXPECT_THROW((void)a.test_many(idx), std::out_of_range);
+    idx.pop_back();
+    std::vector<uint8_t> bytes(3);
+    EXPECT_THROW(a.test_many(idx, bytes),
+                 bitspan_length_mismatch);
+    bytes.pop_back();
+    a.test_many(idx, bytes);
+    EXPECT_EQ(1, bytes[0]);
+    EXPECT_EQ(0, bytes[1]);
+}
+TEST(bitvec, indexing_policy_reaches_its_spans) {
+    bitvec<uint64_t, malloc_alloc, index_unchecked> a(100);
+    static_assert(std::is_same_v<decltype(a.span())::check, index_unchecked>);
+    a[5] = true;
+    a.set_unchecked(99);
+    EXPECT_TRUE(a.test_unchecked(5) && a[99]);
+    bitvec<> b(100);
+    b |= a.span();
+    EXPECT_EQ(2, b.count());
+    EXPECT_THROW((void)b[100], std::out_of_range);
+    b.set_unchecked(5, false);
+    EXPECT_FALSE(b.test_unchecked(5));
+}
+TEST(bitvec, expiring_operands_lend_their_buffer) {
+    auto make = [](size_t len, size_t step) {
+        bitvec<> v(len);
+        for (size_t i = 0; i < len; i += step) v[i] = true;
+        return v;
+    };
+    bitvec<> a = make(200, 2), b = make(130, 3);
+    auto* a_words = a.words().begin();
+    auto* b_words = b.words().begin();
+    bitvec<> c = std::move(a) & b;
+    EXPECT_EQ(a_words, c.words().begin());
+    bitvec<> d = b.span() | std::move(c);
+    EXPECT_EQ(a_words, d.words().begin());
+    bitvec<> e = ~(make(64, 2) ^ std::move(b));
+    EXPECT_EQ(b_words, e.words().begin());
+
+    bitvec<> x = make(200, 2), y = make(130, 3);
+    for (size_t i = 0; i < 200; i++) {
+        bool xi = i % 2 == 0, yi = i < 130 && i % 3 == 0;
+        EXPECT_EQ(xi && yi, (x & y)[i]);
+        EXPECT_EQ(xi && yi, (y & x)[i]);
+        EXPECT_EQ(xi || yi, (make(130, 3) | x)[i]);
+        EXPECT_EQ(xi || yi, (y.span() | make(200, 2))[i]);
+        EXPECT_EQ(xi != yi, (make(130, 3) ^ make(200, 2))[i]);
+        EXPECT_EQ(xi != yi, (x.span() ^ y)[i]);
+        EXPECT_EQ(!xi, (~make(200, 2))[i]);
+    }
+    EXPECT_EQ(200, (make(130, 3) & make(200, 2)).len());
+}
 // NOLINTEND
@@ -0,0 +1,186 @@
+#include "bitvec.hxx"
+#include <cstdint>
+#include <random>
+#include <gtest.h>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// NOLINTBEGIN
+namespace {
+    template<typename A>
+    void check_growth_preserves_bits(size_t from, size_t to) {
+        bitvec<uint64_t, A> a(from);
+        std::mt19937_64 rng(from);
+        std::vector<size_t> set;
+        for (int k = 0; k < 200; k++) { size_t i = rng() % from; a[i] = true; set.push_back(i); }
+        size_t before = a.count();
+        a.resize(to);
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(a.words().begin()) % A::alignment);
+        EXPECT_EQ(before, a.count());
+        for (size_t i : set) EXPECT_TRUE(a[i]);
+        a[to - 1] = true;
+        EXPECT_EQ(before + 1, a.count());
+    }
+}
+
+TEST(bitvec_alloc, line_aligned_storage_is_aligned_through_growth) {
+    using vec = bitvec<uint64_t, line_aligned_alloc<>>;
+    for (size_t len : {1, 63, 64, 1000, 100000}) {
+        vec a(len);
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(a.words().begin()) % 64);
+    }
+    check_growth_preserves_bits<line_aligned_alloc<>>(1000, 100000);
+    check_growth_preserves_bits<line_aligned_alloc<256>>(70, 5000);
+}
+
+TEST(bitvec_alloc, huge_page_storage_crosses_threshold_both_ways) {
+    const size_t threshold_bits = (size_t(2) << 20) * 8;
+    check_growth_preserves_bits<huge_page_alloc<>>(1000, threshold_bits + 1);
+    check_growth_preserves_bits<huge_page_alloc<>>(threshold_bits, 3 * threshold_bits);
+    check_growth_preserves_bits<huge_page_alloc<true>>(threshold_bits + 64, 5 * threshold_bits);
+}
+
+TEST(bitvec_alloc, policies_interoperate_through_spans) {
+    bitvec<uint64_t> a(5000);
+    bitvec<uint64_t, huge_page_alloc<>> b(5000);
+    a[17] = true; b[17] = true; b[4000] = true;
+    EXPECT_TRUE(b.span().is_superset_of(a));
+    b &= a.span();
+    EXPECT_EQ(b.span(), a.span());
+    bitvec<uint64_t, huge_page_alloc<>> c = b, d;
+    d = std::move(c);
+    EXPECT_EQ(1, d.count());
+}
+
+#if defined(__linux__)
+namespace {
+    /// Pages of [p, p + bytes) that are resident.
+    size_t resident_pages(void const* p, size_t bytes) {
+        size_t page = size_t(sysconf(_SC_PAGESIZE));
+        std::vector<unsigned char> vec((bytes + page - 1) / page);
+        mincore(const_cast<void*>(p), bytes, vec.data());
+        size_t n = 0;
+        for (unsigned char v : vec) n += v & 1;
+        return n;
+    }
+}
+
+TEST(bitvec_alloc, reserved_storage_grows_without_moving) {
+    using alloc = reserved_alloc<size_t(1) << 30>;
+    bitvec<uint64_t, alloc> a(100);
+    a[99] = true;
+    auto* base = a.words().begin();
+    auto early = a.span();
+    for (size_t len = 1000; len <= (size_t(64) << 20); len *= 8) {
+        a.resize(len);
+        a[len - 1] = true;
+        EXPECT_EQ(base, a.words().begin());
+    }
+    EXPECT_TRUE(early[99]);
+    EXPECT_EQ(7, a.count());
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(base) % alloc::alignment);
+}
+
+TEST(bitvec_alloc, reserved_storage_stops_at_its_reservation) {
+    using alloc = reserved_alloc<size_t(1) << 20>;
+    const size_t max_bits = (size_t(1) << 20) * 8;
+    EXPECT_EQ(max_bits, (bitvec<uint64_t, alloc>::max_cap));
+    bitvec<uint64_t, alloc> a(max_bits / 2 + 64);
+    a.resize(max_bits); // amortized doubling would overshoot the reservation
+    EXPECT_EQ(max_bits, a.cap());
+    EXPECT_THROW(a.resize(max_bits + 1), std::bad_alloc);
+    EXPECT_THROW((bitvec<uint64_t, alloc>(max_bits + 1)), std::bad_alloc);
+}
+
+TEST(bitvec_alloc, reserved_storage_releases_dropped_pages) {
+    const size_t bits = size_t(1) << 28; // 32 MiB
+    bitvec<uint64_t, reserved_alloc<size_t(1) << 30>> a(bits);
+    a.invert();
+    size_t bytes = bits / 8;
+    EXPECT_GT(resident_pages(a.words().begin(), bytes), bytes / 4096 / 2);
+    a.truncate(100);
+    EXPECT_LE(resident_pages(a.words().begin(), bytes), 1);
+    EXPECT_EQ(100, a.count());
+    a.resize(bits / 2);
+    EXPECT_EQ(100, a.count());
+    a.resize(1);
+    EXPECT_EQ(1, a.count());
+    EXPECT_EQ(bits, a.cap());
+}
+#endif
+namespace {
+    template<typename A>
+    void check_regrowth_clears_old_bits() {
+        bitvec<uint64_t, A> a(10000);
+        a.invert();
+        a.truncate(70);
+        a.resize(300000);
+        EXPECT_EQ(70, a.count());
+        bitvec<uint64_t, A> b(a);
+        b.truncate(0);
+        b.resize(300000);
+        EXPECT_TRUE(b.none());
+    }
+}
+
+TEST(bitvec_alloc, regrowth_clears_previously_written_words) {
+    check_regrowth_clears_old_bits<malloc_alloc>();
+    check_regrowth_clears_old_bits<line_aligned_alloc<>>();
+    check_regrowth_clears_old_bits<huge_page_alloc<>>();
+#if defined(__linux__)
+    check_regrowth_clears_old_bits<reserved_alloc<size_t(1) << 30>>();
+#endif
+}
+
+#if defined(__linux__)
+TEST(bitvec_alloc, large_empty_vectors_do_not_touch_their_pages) {
+    const size_t bits = size_t(1) << 31; // 256 MiB
+    const size_t bytes = bits / 8, limit = (size_t(4) << 20) / 4096;
+    bitvec<uint64_t> calloced(bits);
+    bitvec<uint64_t, huge_page_alloc<>> a(bits);
+    bitvec<uint64_t, reserved_alloc<size_t(1) << 30>> b(bits / 2);
+    b.resize(bits);
+    a[bits - 1] = true;
+    b[bits - 1] = true;
+    EXPECT_LT(resident_pages(calloced.words().begin(), bytes), limit);
+    EXPECT_LT(resident_pages(a.words().begin(), bytes), limit);
+    EXPECT_LT(resident_pages(b.words().begin(), bytes), limit);
+    EXPECT_EQ(1, a.span().count_and(b));
+    EXPECT_EQ(bits, calloced.len());
+}
+#endif
+namespace {
+    struct counting_alloc final {
+        static constexpr size_t alignment = malloc_alloc::alignment;
+        static inline size_t plain = 0, zeroed = 0;
+        [[nodiscard]] static void* allocate(size_t n) noexcept { plain++; return malloc_alloc::allocate(n); }
+        [[nodiscard]] static void* allocate_zeroed(size_t n) noexcept
+            { zeroed++; return malloc_alloc::allocate_zeroed(n); }
+        [[nodiscard]] static void* reallocate(void* p, size_t o, size_t n) noexcept
+            { return malloc_alloc::reallocate(p, o, n); }
+        static void deallocate(void* p, size_t n) noexcept { malloc_alloc::deallocate(p, n); }
+    };
+}
+
+TEST(bitvec_alloc, only_fresh_vectors_ask_for_zeroed_storage) {
+    using vec = bitvec<uint64_t, counting_alloc>;
+    static_assert(vec::allocates_zeroed && !vec::tail_zeroed);
+    vec a(1000), b(1000);
+    a[3] = true;
+    EXPECT_EQ(2, counting_alloc::zeroed);
+    EXPECT_EQ(0, counting_alloc::plain);
+    vec c = a, d = a & b, e = ~a;
+    EXPECT_EQ(2, counting_alloc::zeroed);
+    EXPECT_EQ(3, counting_alloc::plain);
+    EXPECT_EQ(1, c.count());
+    EXPECT_EQ(0, d.count());
+    EXPECT_EQ(999, e.count());
+    vec f;
+    f.reserve_for_exact(64);
+    f.resize(64);
+    EXPECT_EQ(3, counting_alloc::zeroed);
+    EXPECT_TRUE(f.none());
+}
+// NOLINTEND
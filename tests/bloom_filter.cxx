@@ -0,0 +1,165 @@
+#include "bloom_filter.hxx"
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+#include <gtest.h>
+
+// NOLINTBEGIN
+namespace {
+    std::vector<uint64_t> hashes(uint64_t first, size_t n) {
+        std::vector<uint64_t> r(n);
+        for (size_t i = 0; i < n; i++) r[i] = bloom_mix(first + i);
+        return r;
+    }
+    template<typename F>
+    double false_positive_rate(F const& f, size_t n) {
+        size_t hits = 0;
+        for (uint64_t h : hashes(1 << 30, n)) hits += f.contains(h);
+        return double(hits) / double(n);
+    }
+}
+
+TEST(bloom_filter, sizing_follows_capacity_and_rate) {
+    auto f = bloom_filter<>::for_capacity(1000, 0.01);
+    EXPECT_NEAR(9586, double(f.len()), 2);
+    EXPECT_EQ(7, f.k());
+    auto s = split_block_bloom_filter<>::for_capacity(1000, 0.01);
+    EXPECT_EQ(0, s.len() % split_block_bloom_filter<>::block_bits);
+    EXPECT_GE(s.len(), 9586);
+    EXPECT_THROW(bloom_filter<>(0, 3), std::invalid_argument);
+    EXPECT_THROW(bloom_filter<>(64, 0), std::invalid_argument);
+    for (double fpp : {0.0, -1.0, 1.0, 2.0, std::nan("")}) {
+        EXPECT_THROW((void)bloom_filter<>::for_capacity(1000, fpp), std::invalid_argument);
+        EXPECT_THROW((void)split_block_bloom_filter<>::for_capacity(1000, fpp), std::invalid_argument);
+    }
+    EXPECT_THROW((void)bloom_filter<>::for_capacity(SIZE_MAX, 1e-300), std::invalid_argument);
+    EXPECT_THROW((void)split_block_bloom_filter<>::for_capacity(SIZE_MAX, 1e-300), std::invalid_argument);
+}
+
+TEST(bloom_filter, empty_filters_cannot_be_created) {
+    static_assert(!std::is_default_constructible_v<bloom_filter<>>);
+    static_assert(!std::is_default_constructible_v<split_block_bloom_filter<>>);
+    EXPECT_EQ(split_block_bloom_filter<>::block_bits, split_block_bloom_filter<>(0).len());
+}
+
+TEST(bloom_filter, no_false_negatives_and_bounded_false_positives) {
+    auto f = bloom_filter<>::for_capacity(10000, 0.01);
+    auto keys = hashes(0, 10000);
+    for (uint64_t h : keys) f.insert(h);
+    for (uint64_t h : keys) EXPECT_TRUE(f.contains(h));
+    EXPECT_LT(false_positive_rate(f, 100000), 0.02);
+}
+
+TEST(bloom_filter, split_block_no_false_negatives_and_bounded_false_positives) {
+    auto f = split_block_bloom_filter<>::for_capacity(10000, 0.01);
+    auto keys = hashes(0, 10000);
+    for (uint64_t h : keys) f.insert(h);
+    for (uint64_t h : keys) EXPECT_TRUE(f.contains(h));
+    EXPECT_LT(false_positive_rate(f, 100000), 0.02);
+}
+
+TEST(bloom_filter, split_block_sets_one_bit_per_lane_of_one_block) {
+    split_block_bloom_filter<> f(4096);
+    f.insert(bloom_mix(42));
+    auto bits = f.bits();
+    EXPECT_EQ(8, bits.count());
+    size_t block = SIZE_MAX;
+    for (auto it = bits.iter<true>(); auto i = it.next();) {
+        if (block == SIZE_MAX) block = *i / 512;
+        EXPECT_EQ(block, *i / 512);
+    }
+    for (size_t lane = 0; lane < 8; lane++) {
+        size_t in_lane = 0;
+        for (size_t b = 0; b < 64; b++) in_lane += bits[block * 512 + lane * 64 + b];
+        EXPECT_EQ(1, in_lane);
+    }
+}
+
+TEST(bloom_filter, split_block_layout_is_independent_of_word_type) {
+    split_block_bloom_filter<uint64_t> wide(2048);
+    split_block_bloom_filter<uint8_t>  narrow(2048);
+    for (uint64_t h : hashes(5, 200)) { wide.insert(h); narrow.insert(h); }
+    auto w = wide.bits();
+    auto n = narrow.bits();
+    ASSERT_EQ(w.len(), n.len());
+    for (size_t i = 0; i < w.len(); i++) EXPECT_EQ(w[i], n[i]);
+}
+
+TEST(bloom_filter, batch_operations_match_single_key_ones) {
+    auto keys = hashes(0, 3000);
+    auto probes = hashes(2000, 3000);
+    auto one = bloom_filter<>::for_capacity(3000, 0.05), many = one;
+    for (uint64_t h : keys) one.insert(h);
+    many.insert_many(keys);
+    EXPECT_EQ(one.bits(), many.bits());
+    auto out = std::make_unique<bool[]>(probes.size());
+    many.contains_many(probes, {out.get(), probes.size()});
+    for (size_t i = 0; i < probes.size(); i++) EXPECT_EQ(one.contains(probes[i]), out[i]);
+    EXPECT_THROW(many.contains_many(probes, {out.get(), 1}), std::length_error);
+
+    auto sone = split_block_bloom_filter<>::for_capacity(3000, 0.05), smany = sone;
+    for (uint64_t h : keys) sone.insert(h);
+    smany.insert_many(keys);
+    EXPECT_EQ(sone.bits(), smany.bits());
+    smany.contains_many(probes, {out.get(), probes.size()});
+    for (size_t i = 0; i < probes.size(); i++) EXPECT_EQ(sone.contains(probes[i]), out[i]);
+}
+
+TEST(bloom_filter, serialization_round_trips) {
+    auto f = bloom_filter<>::for_capacity(500, 0.01);
+    f.insert_many(hashes(0, 500));
+    std::stringstream ss;
+    f.serialize(ss);
+    auto g = bloom_filter<>::deserialize(ss);
+    EXPECT_EQ(f.k(), g.k());
+    EXPECT_EQ(f.bits(), g.bits());
+
+    split_block_bloom_filter<> s(1024);
+    s.insert_many(hashes(0, 50));
+    std::stringstream ss2;
+    s.serialize(ss2);
+    auto t = split_block_bloom_filter<>::deserialize(ss2);
+    EXPECT_EQ(s.bits(), t.bits());
+    for (uint64_t h : hashes(0, 50)) EXPECT_TRUE(t.contains(h));
+}
+
+TEST(bloom_filter, deserialization_rejects_malformed_input) {
+    std::stringstream empty;
+    EXPECT_THROW((void)bloom_filter<>::deserialize(empty), bloom_format_error);
+
+    bloom_filter<> f(256, 3);
+    std::stringstream ss;
+    f.serialize(ss);
+    std::string bytes = ss.str();
+    std::stringstream wrong_kind(bytes);
+    EXPECT_THROW((void)split_block_bloom_filter<>::deserialize(wrong_kind), bloom_format_error);
+    std::stringstream truncated(bytes.substr(0, bytes.size() - 1));
+    EXPECT_THROW((void)bloom_filter<>::deserialize(truncated), bloom_format_error);
+    std::stringstream narrow(bytes);
+    EXPECT_THROW((void)bloom_filter<uint8_t>::deserialize(narrow), bloom_format_error);
+}
+TEST(bloom_filter, deserialization_checks_claimed_length_against_data) {
+    bloom_filter<> f(256, 3);
+    std::stringstream ss;
+    f.serialize(ss);
+    std::string bytes = ss.str();
+    for (uint64_t len : {uint64_t(1) << 34, uint64_t(1) << 62, ~uint64_t(0)}) {
+        std::string claim = bytes;
+        memcpy(claim.data() + 16, &len, sizeof(len));
+        std::stringstream a(claim), b(claim);
+        EXPECT_THROW((void)bloom_filter<>::deserialize(a), bloom_format_error);
+        EXPECT_THROW((void)split_block_bloom_filter<>::deserialize(b), bloom_format_error);
+    }
+
+    // Larger than one read piece, with a partial last word
+    bloom_filter<> big((size_t(3) << 23) + 5, 2);
+    for (uint64_t h : hashes(0, 1000)) big.insert(h);
+    std::stringstream out;
+    big.serialize(out);
+    auto back = bloom_filter<>::deserialize(out);
+    EXPECT_EQ(big.bits(), back.bits());
+}
+// NOLINTEND
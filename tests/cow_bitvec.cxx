@@ -0,0 +1,100 @@
+#include "cow_bitvec.hxx"
+#include <gtest.h>
+
+// NOLINTBEGIN
+using cow = cow_bitvec<>;
+static constexpr size_t big = 3 * cow::chunk_bits + 100;
+
+static bitvec<> pattern(size_t len, size_t stride) {
+    bitvec<> v(len);
+    for (size_t i = 0; i < len; i += stride) v[i] = true;
+    return v;
+}
+
+TEST(cow_bitvec, new_vector_is_zeroed) {
+    cow v(big);
+    EXPECT_EQ(big, v.len());
+    EXPECT_EQ(4, v.chunk_count());
+    EXPECT_TRUE(v.none());
+    ASSERT_ANY_THROW((void)v[big]);
+}
+
+TEST(cow_bitvec, copy_shares_until_write) {
+    auto src = pattern(big, 7);
+    cow a(src.span());
+    cow b = a;
+    for (size_t c = 0; c < a.chunk_count(); c++) EXPECT_TRUE(a.is_chunk_shared(c));
+    b[cow::chunk_bits + 1] = true;
+    EXPECT_FALSE(a[cow::chunk_bits + 1]);
+    EXPECT_TRUE(b[cow::chunk_bits + 1]);
+    EXPECT_TRUE(a.is_chunk_shared(0));
+    EXPECT_FALSE(b.is_chunk_shared(1));
+    EXPECT_TRUE(a == src.span());
+    EXPECT_FALSE(a == b);
+}
+
+TEST(cow_bitvec, bulk_ops_match_bitvec) {
+    auto va = pattern(big, 3), vb = pattern(big, 5);
+    cow a(va.span()), b(vb.span());
+    cow x = a;
+    x &= b;
+    va &= vb;
+    EXPECT_TRUE(x == va.span());
+    x = a;
+    x ^= a;
+    EXPECT_TRUE(x.none());
+    x = a;
+    x |= b;
+    EXPECT_EQ(a.count() + b.count() - (a & b).count(), x.count());
+    auto inv = ~b;
+    EXPECT_EQ(big - b.count(), inv.count());
+}
+
+TEST(cow_bitvec, ops_with_shorter_bitspan) {
+    auto src = pattern(big, 2);
+    cow a(src.span());
+    auto shorter = pattern(cow::chunk_bits + 10, 4);
+    cow x = a;
+    x &= shorter.span();
+    EXPECT_EQ(shorter.count(), x.count());
+    auto flat = x.to_bitvec();
+    EXPECT_TRUE(x == flat.span());
+    bitvec<> longer(big + 1);
+    ASSERT_ANY_THROW(x |= longer.span());
+}
+TEST(cow_bitvec, reads_through_a_mutable_vector_keep_chunks_shared) {
+    auto src = pattern(big, 7);
+    cow a(src.span());
+    cow b = a;
+    size_t set = 0;
+    for (size_t i = 0; i < big; i += 1000) set += bool(b[i]);
+    EXPECT_EQ((big + 6999) / 7000, set);
+    for (size_t c = 0; c < b.chunk_count(); c++) EXPECT_TRUE(b.is_chunk_shared(c));
+    b[7] = true;
+    b[8] |= false;
+    for (size_t c = 0; c < b.chunk_count(); c++) EXPECT_TRUE(b.is_chunk_shared(c));
+    b[8].flip();
+    b[cow::chunk_bits] ^= true;
+    EXPECT_TRUE(b[8] && b[cow::chunk_bits] && !a[8] && !a[cow::chunk_bits]);
+    EXPECT_FALSE(b.is_chunk_shared(0));
+    EXPECT_FALSE(b.is_chunk_shared(1));
+    EXPECT_TRUE(b.is_chunk_shared(2));
+}
+
+TEST(cow_bitvec, cleared_chunks_are_not_copied) {
+    auto src = pattern(big, 3);
+    cow a(src.span());
+    cow x = a;
+    x ^= a;
+    EXPECT_TRUE(x.none());
+    for (size_t c = 0; c < x.chunk_count(); c++) {
+        EXPECT_NE(a.chunk_span(c).words().begin(), x.chunk_span(c).words().begin());
+        EXPECT_EQ(x.chunk_span(0).words().begin(), x.chunk_span(c).words().begin());
+    }
+    auto first = pattern(cow::chunk_bits, 1);
+    x = a;
+    x &= first.span();
+    EXPECT_EQ(x.chunk_span(1).words().begin(), x.chunk_span(3).words().begin());
+    EXPECT_EQ(a.chunk_span(0).count(), x.count());
+}
+// NOLINTEND
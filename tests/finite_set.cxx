@@ -0,0 +1,84 @@
+#include "finite_set.hxx"
+#include <gtest.h>
+
+// NOLINTBEGIN
+static finite_set<> make_set(size_t universe, std::initializer_list<size_t> elems) {
+    finite_set<> s(universe);
+    for (auto e : elems) s.insert(e);
+    return s;
+}
+
+TEST(finite_set, new_set_is_empty) {
+    finite_set<> s(100);
+    EXPECT_EQ(100, s.universe());
+    for (size_t i = 0; i < s.universe(); i++) EXPECT_FALSE(s.contains(i));
+    EXPECT_TRUE(s.empty());
+    EXPECT_EQ(0, s.count());
+}
+
+TEST(finite_set, insert_and_erase) {
+    finite_set<> s(10);
+    s.insert(3);
+    EXPECT_TRUE(s.contains(3));
+    s.erase(3);
+    EXPECT_FALSE(s.contains(3));
+}
+
+TEST(finite_set, throws_on_element_outside_universe) {
+    finite_set<> s(10);
+    ASSERT_ANY_THROW(s.insert(10));
+    ASSERT_ANY_THROW(s.erase(10));
+    ASSERT_ANY_THROW((void)s.contains(10));
+}
+
+TEST(finite_set, throws_on_universe_mismatch) {
+    finite_set<> a(10), b(11);
+    ASSERT_ANY_THROW(a |= b);
+    ASSERT_ANY_THROW((void)(a & b));
+}
+
+TEST(finite_set, union_intersection_difference_symmetric_difference) {
+    const size_t n = 130;
+    auto a = make_set(n, {1, 2, 64, 100, 129});
+    auto b = make_set(n, {2, 3, 64, 128});
+    EXPECT_EQ(make_set(n, {1, 2, 3, 64, 100, 128, 129}), a | b);
+    EXPECT_EQ(make_set(n, {2, 64}),                      a & b);
+    EXPECT_EQ(make_set(n, {1, 100, 129}),                a - b);
+    EXPECT_EQ(make_set(n, {1, 3, 100, 128, 129}),        a ^ b);
+    EXPECT_EQ(7, a.count_union(b));
+    EXPECT_EQ(2, a.count_intersection(b));
+    EXPECT_EQ(3, a.count_difference(b));
+    EXPECT_EQ(5, a.count_symmetric_difference(b));
+}
+
+TEST(finite_set, subset_and_disjoint_predicates) {
+    auto a = make_set(100, {1, 70});
+    auto b = make_set(100, {1, 2, 70});
+    auto c = make_set(100, {3, 99});
+    EXPECT_TRUE(a.is_subset_of(b));
+    EXPECT_FALSE(b.is_subset_of(a));
+    EXPECT_TRUE(b.is_superset_of(a));
+    EXPECT_TRUE(a.is_disjoint(c));
+    EXPECT_TRUE(a.intersects(b));
+    ASSERT_ANY_THROW((void)a.is_subset_of(finite_set<>(101)));
+}
+
+TEST(finite_set, complement_is_relative_to_universe) {
+    const size_t n = 70;
+    auto a = make_set(n, {0, 5, 69});
+    auto c = ~a;
+    for (size_t i = 0; i < n; i++) EXPECT_NE(a.contains(i), c.contains(i));
+    // No stray bits past the universe survive the inversion
+    auto words = c.bits().words();
+    EXPECT_EQ(0, words[words.count() - 1] >> (n % bitspan<>::bits_per_word));
+    EXPECT_EQ(a, ~c);
+}
+
+TEST(finite_set, in_place_ops_do_not_reallocate) {
+    auto a = make_set(200, {1, 199});
+    auto b = make_set(200, {1, 2});
+    auto const* base = a.bits().words().begin();
+    a |= b; a &= b; a -= b; a ^= b; a.complement();
+    EXPECT_EQ(base, a.bits().words().begin());
+}
+// NOLINTEND
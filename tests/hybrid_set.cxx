@@ -0,0 +1,66 @@
+#include "hybrid_set.hxx"
+#include <random>
+#include <gtest.h>
+
+// NOLINTBEGIN
+static constexpr size_t universe = 1 << 14;
+
+static hybrid_set<> random_hybrid(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    hybrid_set<> s(universe);
+    while (s.count() < n) s.insert(rng() % universe);
+    return s;
+}
+
+TEST(hybrid_set, switches_with_hysteresis) {
+    hybrid_set<> s(universe);
+    EXPECT_FALSE(s.is_dense());
+    size_t up = universe / 32 + 1, down = universe / 128;
+    for (size_t i = 0; i < up; i++) s.insert(i);
+    EXPECT_TRUE(s.is_dense());
+    // Dropping back under the upper bound is not enough to switch back
+    for (size_t i = up; i-- > universe / 64;) s.erase(i);
+    EXPECT_TRUE(s.is_dense());
+    for (size_t i = universe / 64; i-- >= down;) s.erase(i);
+    EXPECT_FALSE(s.is_dense());
+    EXPECT_EQ(down - 1, s.count());
+    for (size_t i = 0; i + 1 < down; i++) EXPECT_TRUE(s.contains(i));
+}
+
+TEST(hybrid_set, custom_policy) {
+    hybrid_set<> s(100, {.to_dense = 0.5, .to_sparse = 0.1});
+    for (size_t i = 0; i < 50; i++) s.insert(i);
+    EXPECT_FALSE(s.is_dense());
+    s.insert(50);
+    EXPECT_TRUE(s.is_dense());
+}
+
+TEST(hybrid_set, rejects_thresholds_that_would_thrash) {
+    for (hybrid_policy p : {hybrid_policy{.to_dense = 0.1, .to_sparse = 0.1},
+                            hybrid_policy{.to_dense = 0.1, .to_sparse = 0.5},
+                            hybrid_policy{.to_dense = 1.5, .to_sparse = 0.1},
+                            hybrid_policy{.to_dense = 0.5, .to_sparse = -0.1}})
+        EXPECT_THROW(hybrid_set<>(100, p), std::invalid_argument);
+    EXPECT_NO_THROW(hybrid_set<>(100, {.to_dense = 1, .to_sparse = 0}));
+}
+
+TEST(hybrid_set, every_representation_pair_matches_bitvec) {
+    // 100 members stay sparse, 4000 are dense
+    for (size_t na : {100, 4000}) for (size_t nb : {100, 4000}) {
+        auto a = random_hybrid(na, 1), b = random_hybrid(nb, 2);
+        EXPECT_EQ(na > 1000, a.is_dense());
+        auto va = a.to_bitvec(), vb = b.to_bitvec();
+        auto check = [](hybrid_set<> const& got, bitvec<> const& expect) {
+            EXPECT_TRUE(got.to_bitvec() == expect);
+            EXPECT_EQ(expect.count(), got.count());
+        };
+        check(a & b, va & vb);
+        check(a | b, va | vb);
+        check(a ^ b, va ^ vb);
+        check(a - b, bitvec<>(va).and_not(vb));
+        EXPECT_EQ(va.count_and(vb), a.count_intersection(b));
+        EXPECT_TRUE((a & b).is_subset_of(a));
+        EXPECT_TRUE((a | b) == (b | a));
+    }
+}
+// NOLINTEND
@@ -0,0 +1,77 @@
+#include "persistent_bitvec.hxx"
+#include <vector>
+#include <gtest.h>
+
+// NOLINTBEGIN
+using pbv = persistent_bitvec<>;
+// Three levels of inner nodes, with a partial last leaf
+static constexpr size_t big = pbv::leaf_bits * pbv::fanout * 3 + 77;
+
+static bitvec<> pattern(size_t len, size_t stride, size_t offset = 0) {
+    bitvec<> v(len);
+    for (size_t i = offset; i < len; i += stride) v[i] = true;
+    return v;
+}
+
+TEST(persistent_bitvec, new_vector_is_empty) {
+    pbv v(big);
+    EXPECT_EQ(big, v.len());
+    EXPECT_TRUE(v.none());
+    EXPECT_EQ(0, v.count());
+    EXPECT_FALSE(v[big - 1]);
+    ASSERT_ANY_THROW((void)v[big]);
+}
+
+TEST(persistent_bitvec, updates_leave_old_versions_intact) {
+    std::vector<pbv> versions {pbv(big)};
+    for (size_t i : {size_t(5), big - 1, pbv::leaf_bits * 70, size_t(6)})
+        versions.push_back(versions.back().set(i));
+    EXPECT_EQ(0, versions[0].count());
+    EXPECT_EQ(1, versions[1].count());
+    EXPECT_EQ(4, versions[4].count());
+    EXPECT_TRUE(versions[4][big - 1]);
+    EXPECT_FALSE(versions[1][big - 1]);
+    // Only the touched chunk was copied
+    EXPECT_TRUE (versions[3].shares_chunk_with(versions[2], 0));
+    EXPECT_FALSE(versions[4].shares_chunk_with(versions[3], 0));
+    EXPECT_TRUE (versions[4].shares_chunk_with(versions[3], 70));
+    // Clearing the only bit restores the canonical empty tree
+    EXPECT_TRUE(versions[1].reset(5) == versions[0]);
+}
+
+TEST(persistent_bitvec, bulk_ops_match_bitvec) {
+    auto va = pattern(big, 3), vb = pattern(big, 1000, 7);
+    pbv a(va.span()), b(vb.span());
+    EXPECT_EQ(va.count(), a.count());
+    auto check = [](pbv const& p, bitvec<> const& v) {
+        auto flat = p.to_bitvec();
+        EXPECT_TRUE(flat == v);
+        EXPECT_TRUE(pbv(v.span()) == p);
+    };
+    check(a & b, va & vb);
+    check(a | b, va | vb);
+    check(a ^ b, va ^ vb);
+    check(~a, ~va);
+    check(a.and_not(b), bitvec<>(va).and_not(vb));
+    EXPECT_TRUE((a ^ a).none());
+    EXPECT_TRUE((~~a) == a);
+}
+
+TEST(persistent_bitvec, for_each_chunk_skips_zero_chunks) {
+    auto v = pbv(big).set(3).set(pbv::leaf_bits * 100 + 1);
+    std::vector<size_t> seen;
+    v.for_each_chunk([&](size_t c, bitspan<const uintptr_t> s) { seen.push_back(c); EXPECT_TRUE(s.any()); });
+    EXPECT_EQ((std::vector<size_t>{0, 100}), seen);
+}
+TEST(persistent_bitvec, bulk_construction_matches_updates) {
+    auto v = pattern(big, pbv::leaf_bits * 9 + 13, 5);
+    pbv updated(big);
+    for (size_t i = 5; i < big; i += pbv::leaf_bits * 9 + 13) updated = updated.set(i);
+    pbv built(v.span());
+    EXPECT_TRUE(built == updated);
+    EXPECT_EQ(v.count(), built.count());
+    auto zeros = bitvec<>(big), ones = pattern(big, 1);
+    EXPECT_TRUE(pbv(zeros.span()) == pbv(big));
+    EXPECT_TRUE(pbv(ones.span()) == ~pbv(big));
+}
+// NOLINTEND
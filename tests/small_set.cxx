@@ -0,0 +1,73 @@
+#include "small_set.hxx"
+#include "finite_set.hxx"
+#include <cstdint>
+#include <vector>
+#include <gtest.h>
+
+// NOLINTBEGIN
+static_assert(sizeof(small_set<64>) == sizeof(uint64_t));
+static_assert(small_set<10>({1, 3}).count() == 2);
+static_assert((small_set<10>({1, 3}) | small_set<10>({3, 9})) == small_set<10>({1, 3, 9}));
+static_assert((~small_set<10>()).count() == 10);
+static_assert(small_set<10>({4}).is_subset_of(small_set<10>({4, 5})));
+
+TEST(small_set, membership) {
+    small_set<64> s;
+    EXPECT_TRUE(s.empty());
+    s.insert(0).insert(63);
+    EXPECT_TRUE(s.contains(0));
+    EXPECT_TRUE(s.contains(63));
+    EXPECT_FALSE(s.contains(1));
+    s.erase(0);
+    EXPECT_FALSE(s.contains(0));
+    s.assign(5, true);
+    EXPECT_EQ(2, s.count());
+    ASSERT_ANY_THROW(s.insert(64));
+    ASSERT_ANY_THROW((void)s.contains(64));
+}
+
+TEST(small_set, complement_stays_in_universe) {
+    small_set<70, uint8_t> s {0, 69};
+    auto c = ~s;
+    EXPECT_EQ(68, c.count());
+    EXPECT_FALSE(c.contains(0));
+    EXPECT_EQ(0, c.bits() >> 70);
+    auto all = ~small_set<70, uint8_t>();
+    EXPECT_TRUE((s | c) == all);
+}
+
+TEST(small_set, iterates_in_order) {
+    small_set<128> s {127, 0, 64, 63, 5};
+    std::vector<size_t> seen;
+    for (auto it = s.members(); auto i = it.next();) seen.push_back(*i);
+    EXPECT_EQ((std::vector<size_t>{0, 5, 63, 64, 127}), seen);
+    EXPECT_EQ(0, s.min());
+    EXPECT_EQ(128, small_set<128>().min());
+}
+
+TEST(small_set, matches_finite_set) {
+    small_set<100> a {1, 2, 64, 99}, b {2, 3, 99};
+    finite_set<> fa(100), fb(100);
+    a.for_each([&](size_t i) { fa.insert(i); });
+    b.for_each([&](size_t i) { fb.insert(i); });
+    EXPECT_TRUE(fa.span() == a);
+    EXPECT_EQ(fa.count_union(fb),                a.count_union(b));
+    EXPECT_EQ(fa.count_intersection(fb),         a.count_intersection(b));
+    EXPECT_EQ(fa.count_difference(fb),           a.count_difference(b));
+    EXPECT_EQ(fa.count_symmetric_difference(fb), a.count_symmetric_difference(b));
+    auto d = a - b;
+    auto fd = fa - fb;
+    EXPECT_TRUE(fd.span() == d);
+}
+
+TEST(small_set, from_bitspan) {
+    bitvec<> v(100);
+    v[7] = true;
+    v[90] = true;
+    small_set<100> s(v.span());
+    EXPECT_EQ(2, s.count());
+    EXPECT_TRUE(s.contains(90));
+    bitvec<> w(99);
+    ASSERT_ANY_THROW((small_set<100>(w.span())));
+}
+// NOLINTEND
@@ -0,0 +1,73 @@
+#include "sparse_set.hxx"
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <tuple>
+#include <vector>
+#include <gtest.h>
+
+// NOLINTBEGIN
+static constexpr size_t universe = 1 << 20;
+
+static sparse_set<> random_sparse(size_t n, size_t limit, unsigned seed) {
+    std::mt19937 rng(seed);
+    sparse_set<> s(universe);
+    for (size_t k = 0; k < n; k++) s.insert(rng() % limit);
+    return s;
+}
+
+TEST(sparse_set, membership) {
+    sparse_set<> s(100);
+    s.insert(50).insert(3).insert(50).insert(99);
+    EXPECT_EQ(3, s.count());
+    EXPECT_TRUE(s.contains(3));
+    EXPECT_FALSE(s.contains(4));
+    EXPECT_TRUE(std::is_sorted(s.elements().begin(), s.elements().end()));
+    s.erase(3).erase(4);
+    EXPECT_EQ(2, s.count());
+    ASSERT_ANY_THROW(s.insert(100));
+    ASSERT_ANY_THROW((sparse_set<uintptr_t, uint8_t>(257)));
+}
+
+TEST(sparse_set, algebra_matches_std_algorithms) {
+    // Balanced sizes take the merge (and AVX2 block) paths, skewed ones gallop
+    for (auto [na, nb, limit] : {std::tuple{3000, 2500, 8000}, {20, 5000, 100000}, {5000, 20, 100000}}) {
+        auto a = random_sparse(na, limit, 1), b = random_sparse(nb, limit, 2);
+        auto ea = a.elements(), eb = b.elements();
+        std::vector<uint32_t> expect;
+        auto check = [&](sparse_set<> const& got) {
+            EXPECT_TRUE(std::equal(got.elements().begin(), got.elements().end(),
+                                   expect.begin(), expect.end()));
+            expect.clear();
+        };
+        std::set_intersection(ea.begin(), ea.end(), eb.begin(), eb.end(), std::back_inserter(expect));
+        EXPECT_EQ(expect.size(), a.count_intersection(b));
+        check(a & b);
+        std::set_union(ea.begin(), ea.end(), eb.begin(), eb.end(), std::back_inserter(expect));
+        EXPECT_EQ(expect.size(), a.count_union(b));
+        check(a | b);
+        std::set_difference(ea.begin(), ea.end(), eb.begin(), eb.end(), std::back_inserter(expect));
+        check(a - b);
+        std::set_symmetric_difference(ea.begin(), ea.end(), eb.begin(), eb.end(),
+                                      std::back_inserter(expect));
+        check(a ^ b);
+    }
+}
+
+TEST(sparse_set, mixed_with_dense) {
+    auto a = random_sparse(500, universe, 3), b = random_sparse(50000, universe, 4);
+    auto dense = b.to_bitvec();
+    EXPECT_EQ(b.count(), dense.count());
+    EXPECT_TRUE(sparse_set<>(dense.span()) == b);
+    EXPECT_EQ(a.count_intersection(b), a.count_intersection(dense.span()));
+    auto x = a;
+    x &= dense.span();
+    EXPECT_TRUE(x == (a & b));
+    x = a;
+    x -= dense.span();
+    EXPECT_TRUE(x == (a - b));
+    EXPECT_TRUE((a & b).is_subset_of(dense.span()));
+    bitvec<> small(10);
+    ASSERT_ANY_THROW((void)a.intersects(small.span()));
+}
+// NOLINTEND
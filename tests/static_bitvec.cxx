@@ -0,0 +1,82 @@
+#include "static_bitvec.hxx"
+#include "bitvec.hxx"
+#include <cstdint>
+#include <gtest.h>
+
+// NOLINTBEGIN
+template<size_t N, bitspan_word W = default_bitspan_word>
+static constexpr static_bitvec<N, W> make_static(std::initializer_list<size_t> elems) {
+    static_bitvec<N, W> b;
+    for (auto e : elems) b.set(e);
+    return b;
+}
+
+// Everything that does not go through a bitspan is usable in constant expressions
+static_assert(make_static<70>({1, 69}).count() == 2);
+static_assert((make_static<70>({1, 2}) & make_static<70>({2, 3})) == make_static<70>({2}));
+static_assert((make_static<70>({1}) | make_static<70>({69})) == make_static<70>({1, 69}));
+static_assert((~static_bitvec<70>()).count() == 70);
+static_assert(make_static<70>({5}).is_subset_of(make_static<70>({5, 6})));
+static_assert(static_bitvec<70>::word_count == 2 || static_bitvec<70>::bits_per_word != 64);
+
+TEST(static_bitvec, new_vector_is_zeroed) {
+    static_bitvec<100> b;
+    EXPECT_EQ(100, b.len());
+    for (size_t i = 0; i < b.len(); i++) EXPECT_FALSE(b[i]);
+    EXPECT_TRUE(b.none());
+}
+
+TEST(static_bitvec, throws_on_index_out_of_range) {
+    static_bitvec<10> b;
+    ASSERT_ANY_THROW(b.set(10));
+    ASSERT_ANY_THROW((void)b.test(10));
+}
+
+TEST(static_bitvec, bit_ref_writes_through) {
+    static_bitvec<10> b;
+    b[3] = true;
+    EXPECT_TRUE(b.test(3));
+    b[3] = false;
+    EXPECT_TRUE(b.none());
+}
+
+TEST(static_bitvec, invert_and_reset_keep_residual_clear) {
+    static_bitvec<70, uint8_t> b;
+    b.invert();
+    EXPECT_EQ(70, b.count());
+    EXPECT_EQ(0x3f, b.words()[8]);
+    b.reset(true);
+    EXPECT_EQ(70, b.count());
+    b.reset();
+    EXPECT_TRUE(b.none());
+}
+
+TEST(static_bitvec, ops_match_bitvec) {
+    auto a = make_static<200>({0, 63, 64, 150, 199}), b = make_static<200>({63, 100, 199});
+    bitvec<> va(200), vb(200);
+    va.set_from(a);
+    vb.set_from(b);
+    bitvec<> vand = va & vb, vor = va | vb, vxor = va ^ vb, vnot = ~va;
+    EXPECT_TRUE(va.span() == a);
+    auto sand = a & b, sor = a | b, sxor = a ^ b, snot = ~a;
+    EXPECT_TRUE(vand.span() == sand);
+    EXPECT_TRUE(vor.span()  == sor);
+    EXPECT_TRUE(vxor.span() == sxor);
+    EXPECT_TRUE(vnot.span() == snot);
+    EXPECT_EQ(va.intersects(vb), a.intersects(b));
+    EXPECT_EQ(va.is_subset_of(vb), a.is_subset_of(b));
+}
+
+TEST(static_bitvec, interoperates_with_bitspan) {
+    auto a = make_static<100>({1, 50, 99});
+    bitvec<> v(100);
+    v.set_from(a);
+    v[2] = true;
+    a |= v;
+    EXPECT_EQ(4, a.count());
+    a.and_not(v);
+    EXPECT_TRUE(a.none());
+    bitvec<> shorter(10);
+    ASSERT_ANY_THROW(shorter |= a);
+}
+// NOLINTEND
@@ -0,0 +1,51 @@
+#include "summary_bitvec.hxx"
+#include <random>
+#include <set>
+#include <gtest.h>
+
+// NOLINTBEGIN
+TEST(summary_bitvec, levels_shrink_to_one_word) {
+    summary_bitvec<uint64_t> s(size_t(1) << 20);
+    EXPECT_EQ(4, s.level_count()); // 2^20, 2^14, 2^8, 2^2 bits
+    EXPECT_EQ(1, summary_bitvec<uint64_t>(64).level_count());
+    EXPECT_TRUE(s.empty());
+    EXPECT_FALSE(s.min());
+    EXPECT_FALSE(s.max());
+    EXPECT_TRUE(summary_bitvec<>(0).empty());
+}
+
+TEST(summary_bitvec, search_matches_std_set) {
+    const size_t len = 300000;
+    summary_bitvec<> s(len);
+    std::set<size_t> ref;
+    std::mt19937_64 rng(7);
+    for (int round = 0; round < 2000; round++) {
+        size_t i = rng() % len;
+        if (rng() % 3) { s.set(i); ref.insert(i); } else { s.reset(i); ref.erase(i); }
+        size_t q = rng() % len;
+        auto next = ref.lower_bound(q);
+        EXPECT_EQ(next == ref.end() ? std::nullopt : std::optional<size_t>(*next), s.find_next(q));
+        auto prev = ref.upper_bound(q);
+        EXPECT_EQ(prev == ref.begin() ? std::nullopt : std::optional<size_t>(*std::prev(prev)),
+                  s.find_prev(q));
+    }
+    EXPECT_EQ(ref.size(), s.count());
+    EXPECT_EQ(*ref.begin(), s.min());
+    EXPECT_EQ(*ref.rbegin(), s.max());
+    for (size_t i : ref) s.reset(i);
+    EXPECT_TRUE(s.empty());
+}
+
+TEST(summary_bitvec, assign_rebuilds_summaries) {
+    bitvec<> v(5000);
+    v[4999] = true;
+    v[17] = true;
+    summary_bitvec<> s(v.span());
+    EXPECT_EQ(17, s.min());
+    EXPECT_EQ(4999, s.max());
+    EXPECT_EQ(4999, s.find_next(18));
+    EXPECT_EQ(17, s.find_prev(4998));
+    EXPECT_FALSE(s.find_next(5000));
+    ASSERT_ANY_THROW(s.set(5000));
+}
+// NOLINTEND